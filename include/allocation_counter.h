@@ -0,0 +1,20 @@
+/*!
+ * @file
+ * @brief Подсчет выделений динамической памяти для проверки того, что обработка кадра не выделяет память
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace memory {
+
+/*!
+ * @brief Количество выделений памяти с начала работы программы
+ * Учитываются все вызовы глобальных operator new во всех потоках. Счетчик общий, поэтому разность
+ * показаний вокруг участка кода включает выделения других потоков, работавших в это время.
+ */
+size_t allocations();
+
+}  // namespace memory
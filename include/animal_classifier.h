@@ -0,0 +1,111 @@
+/*!
+ * @file
+ * @brief Классификатор вида животного по признакам пантомимики и звука
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include "feature_batch.h"
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace translator {
+
+/*!
+ * @brief Классификатор вида животного
+ * Каждый вид оценивается по попаданию признаков в диапазоны, характерные для вида (animal_sizes, animal_frequency,
+ * animal_volume, animal_throat, animal_larynx), побеждает вид с наибольшей оценкой. Классификация выполняется сразу
+ * для пакета животных с использованием SIMD-инструкций, набор инструкций выбирается при запуске по возможностям
+ * процессора. Скалярная классификация развернута по видам и сравнивает признаки с константами вида (см.
+ * SpeciesTraits), векторные реализации и обобщенная скалярная берут признаки видов из плотных таблиц Profile.
+ */
+class AnimalClassifier {
+public:
+    /// @brief Набор инструкций для классификации
+    enum Isa {
+        kScalar = 0,
+        kSse41,
+        kAvx2,
+        kMaxIsa,
+    };
+
+    /*!
+     * @brief Создание классификатора
+     * Признаки видов собираются в плотные таблицы, выбирается лучший доступный набор инструкций.
+     */
+    AnimalClassifier();
+
+    /*!
+     * @brief Классификация пакета животных
+     * @param[in] pantomime Пантомимика животных пакета
+     * @param[in] sound Звуки животных пакета
+     * @param[out] types Виды животных, размер не меньше количества животных в пакете
+     */
+    void classify(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                  std::span<animal::AnimalType> types) const;
+
+    /*!
+     * @brief Классификация одного животного
+     * @param[in] pantomime Пантомимика животного
+     * @param[in] sound Звук животного
+     * @return Вид животного
+     */
+    animal::AnimalType classify(const pantomime::Pantomime& pantomime, const syllable::Sound& sound) const;
+
+    /*!
+     * @brief Классификация части пакета заданным набором инструкций
+     * Части пакета не пересекаются по выходным элементам, поэтому их можно классифицировать из разных потоков.
+     * @param[in] pantomime Пантомимика животных пакета
+     * @param[in] sound Звуки животных пакета
+     * @param[out] types Виды животных, размер не меньше количества животных в пакете
+     * @param[in] isa Набор инструкций; если процессор его не поддерживает, выбирается лучший из доступных
+     * @param[in] begin Первое животное части
+     * @param[in] end Животное, следующее за последним животным части
+     * @param[in] specialized Скалярная классификация развернута по видам; иначе признаки видов читаются из Profile
+     */
+    void classify(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                  std::span<animal::AnimalType> types, Isa isa, size_t begin, size_t end,
+                  bool specialized = true) const;
+
+    Isa isa() const { return isa_; }
+
+    /// @brief Лучший набор инструкций, поддерживаемый процессором (определен при создании классификатора)
+    Isa bestIsa() const { return detected_; }
+
+    /*!
+     * @brief Выбор набора инструкций
+     * @param[in] isa Желаемый набор инструкций. Если процессор его не поддерживает, выбирается лучший из доступных
+     * @return Выбранный набор инструкций
+     */
+    Isa setIsa(Isa isa);
+
+    /// @brief Лучший набор инструкций, поддерживаемый процессором
+    static Isa detectIsa();
+
+    static constexpr std::array<const char*, kMaxIsa> kIsaNames = {"scalar", "sse4.1", "avx2"};
+
+    /// @brief Веса признаков в оценке вида
+    static constexpr int32_t kRangeWeight    = 1;
+    static constexpr int32_t kCategoryWeight = 2;
+
+    /// @brief Признаки видов в виде плотных таблиц
+    struct Profile {
+        std::array<int32_t, animal::MaxAnimalType> size_min;
+        std::array<int32_t, animal::MaxAnimalType> size_max;
+        std::array<int32_t, animal::MaxAnimalType> volume_min;
+        std::array<int32_t, animal::MaxAnimalType> volume_max;
+        std::array<float, animal::MaxAnimalType> frequency_max;
+        std::array<uint32_t, animal::MaxAnimalType> larynx_mask;  ///< Битовая маска характерных звуков гортани
+        std::array<uint32_t, animal::MaxAnimalType> throat_mask;  ///< Битовая маска характерных горловых звуков
+    };
+
+private:
+    Profile profile_;
+    Isa isa_;
+    Isa detected_;
+};
+
+}  // namespace translator
@@ -6,10 +6,17 @@
  */
 #pragma once
 
+#include "sample_ring.h"
+#include "spsc_ring.h"
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <ctime>
-#include <map>
+#include <initializer_list>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace pantomime {
@@ -46,8 +53,33 @@ struct Pantomime {
     long size;
 };
 
+/// @brief Фокусное расстояние камер стереопары, пиксели
+inline constexpr double kFocalLength = 800;
+/// @brief Расстояние между камерами стереопары, м
+inline constexpr double kStereoBaseline = 1;
+/// @brief Размер кадра видео по умолчанию (720p)
+inline constexpr unsigned kFrameWidth  = 1280;
+inline constexpr unsigned kFrameHeight = 720;
+
+/// @brief Видео без владения данными (например, кадр записанного сеанса в отображенном в память файле)
+struct VideoView {
+    std::span<const Pantomime> figures;
+    std::span<const uint8_t> disparity;
+    unsigned width  = 0;
+    unsigned height = 0;
+};
+
 struct Video {
     std::vector<Pantomime> figures;
+    /// @brief Карта диспаритета стереопары, 8 бит на пиксель построчно (0 - фон), пусто - если доступны только
+    /// предзаготовленные фигуры
+    std::vector<uint8_t> disparity;
+    unsigned width  = 0;
+    unsigned height = 0;
+
+    VideoView view() const {
+        return (VideoView){.figures = figures, .disparity = disparity, .width = width, .height = height};
+    }
 };
 
 }  // namespace pantomime
@@ -82,45 +114,119 @@ struct Sound {
     double duration;
 };
 
+/// @brief Громкость звука, соответствующая полной шкале цифрового сигнала (амплитуда 1.0)
+inline constexpr double kFullScaleVolume = 140;
+
+/// @brief Частота дискретизации по умолчанию, Гц. Выбрана так, чтобы захватывать частоты всех видов животных
+inline constexpr unsigned kDefaultSampleRate = 96000;
+
 struct Noise {
     std::vector<Sound> noises;
+    /// @brief Позиция начала беседы в потоке отсчетов микрофона
+    size_t sample_begin = 0;
+    /// @brief Длина беседы в отсчетах, 0 - если доступны только предзаготовленные звуки
+    size_t sample_count = 0;
+    /// @brief Частота дискретизации записанного звука, Гц
+    unsigned sample_rate = 0;
+};
+
+/// @brief Беседа без владения данными, звук которой записан целиком (например, в записанном сеансе)
+struct NoiseView {
+    std::span<const Sound> noises;
+    std::span<const float> samples;
+    unsigned sample_rate = 0;
 };
 
 }  // namespace syllable
 
 namespace animal {
 
+enum AnimalType {
+    Cat = 0,
+    Dog,
+    Parrot,
+    Cow,
+    Sheep,
+    MaxAnimalType,
+};
+
 struct PackedData {
     bool ready;
     syllable::Noise noise;
     pantomime::Video video;
     double distance;
+    std::vector<AnimalType> types;
 };
 
 struct PreparedData {
     bool ready;
     std::vector<pantomime::Pantomime> pantomime;
     std::vector<syllable::Sound> sound;
+    std::vector<AnimalType> types;
 };
 
-enum AnimalType {
-    Cat = 0,
-    Dog,
-    Parrot,
-    Cow,
-    Sheep,
-    MaxAnimalType,
+/*!
+ * @brief Таблица признака, индексируемая видом животного
+ * Виды образуют плотное перечисление, поэтому поиск по таблице - это обращение к элементу массива.
+ */
+template <typename T>
+using AnimalTable = std::array<T, MaxAnimalType>;
+
+/*!
+ * @brief Построение таблицы признака с проверкой, что значения заданы для каждого вида
+ * @param[in] values Значения признака в порядке перечисления AnimalType
+ */
+template <typename T, typename... Values>
+    requires(sizeof...(Values) == MaxAnimalType)
+constexpr AnimalTable<T> makeAnimalTable(Values... values) {
+    return {T(values)...};
+}
+
+/*!
+ * @brief Множество значений признака фиксированной емкости без выделения памяти
+ */
+template <typename T, size_t N>
+struct TraitSet {
+    std::array<T, N> values;
+    size_t count;
+
+    constexpr TraitSet(std::initializer_list<T> items) : values{}, count(items.size()) {
+        size_t iter = 0;
+        for (T item : items) values[iter++] = item;
+    }
+
+    constexpr size_t size() const { return count; }
+
+    constexpr T operator[](size_t iter) const { return values[iter]; }
+
+    constexpr const T* begin() const { return values.data(); }
+
+    constexpr const T* end() const { return values.data() + count; }
 };
 
-extern std::map<AnimalType, std::pair<long, long>> animal_sizes;
+inline constexpr AnimalTable<std::pair<long, long>> animal_sizes = makeAnimalTable<std::pair<long, long>>(
+    std::pair{45, 60}, std::pair{22, 140}, std::pair{15, 40}, std::pair{150, 270}, std::pair{60, 110});
 
-extern std::map<AnimalType, double> animal_frequency;
+inline constexpr AnimalTable<double> animal_frequency = makeAnimalTable<double>(20000, 1500, 20000, 35000, 1000);
 
-extern std::map<AnimalType, std::pair<int, int>> animal_volume;
+inline constexpr AnimalTable<std::pair<int, int>> animal_volume = makeAnimalTable<std::pair<int, int>>(
+    std::pair{20, 85}, std::pair{60, 120}, std::pair{40, 135}, std::pair{70, 105}, std::pair{70, 110});
 
-extern std::map<AnimalType, std::vector<syllable::ThroatSound>> animal_throat;
+inline constexpr AnimalTable<TraitSet<syllable::ThroatSound, 2>> animal_throat = {{
+    {syllable::ThroatSound::None, syllable::ThroatSound::Meow},
+    {syllable::ThroatSound::None, syllable::ThroatSound::Woof},
+    {syllable::ThroatSound::None, syllable::ThroatSound::Tweeting},
+    {syllable::ThroatSound::None, syllable::ThroatSound::Moo},
+    {syllable::ThroatSound::None, syllable::ThroatSound::Bleat},
+}};
 
-extern std::map<AnimalType, std::vector<syllable::LarynxSound>> animal_larynx;
+inline constexpr AnimalTable<TraitSet<syllable::LarynxSound, 3>> animal_larynx = {{
+    {syllable::LarynxSound::Purring, syllable::LarynxSound::Hiss, syllable::LarynxSound::Growl},
+    {syllable::LarynxSound::Growl},
+    {syllable::LarynxSound::Chirp},
+    {syllable::LarynxSound::Mooing},
+    {syllable::LarynxSound::Bleating},
+}};
 
 struct AnimalCharacteristic {
     pantomime::Pantomime body;
@@ -129,18 +235,66 @@ struct AnimalCharacteristic {
 
 struct DecodedAnimalCharacteristic {
     AnimalType animal_type;
-    std::string message;
+    /// @brief Переведенное сообщение; указывает в каталог сообщений, который живет до завершения процесса
+    std::string_view message;
     AnimalCharacteristic animal;
+    /// @brief Номер животного, постоянный между кадрами (0 - животное не сопровождается)
+    uint64_t track = 0;
 };
 
 struct AnimalDecodingStub {
     std::vector<AnimalType> types;
 };
 
+/// @brief Единый кадр входного потока: видео, звук и типы животных передаются вместе и не могут рассинхронизироваться
+struct Frame {
+    pantomime::Video video;
+    syllable::Noise noise;
+    AnimalDecodingStub types;
+    /// @brief Показания дальномера: расстояние до центрального пикселя кадра, м (0 - фон вне диапазона)
+    double distance = 0;
+};
+
+/// @brief Поток кадров от окружения к датчикам устройства
+using FrameRing = concurrency::SpscRing<Frame>;
+
+/// @brief Непрерывный поток отсчетов микрофона от окружения к датчикам устройства
+using AudioRing = concurrency::SampleRing<float>;
+
 namespace random {
 
 DecodedAnimalCharacteristic generateAnimal();
 
+/*!
+ * @brief Съемка беседы стереокамерой
+ * Фигуры располагаются слева направо в собственных столбцах кадра на случайном расстоянии, высота фигуры на
+ * изображении пропорциональна ее размеру. Диспаритет фигуры искажен общей для кадра ошибкой калибровки камер.
+ * @param[in,out] video Видео, в которое записывается карта диспаритета
+ * @param[in] width Ширина кадра
+ * @param[in] height Высота кадра
+ * @return Показания дальномера для центрального пикселя кадра, м
+ */
+double renderVideo(pantomime::Video& video, unsigned width, unsigned height);
+
+/*!
+ * @brief Длина записи беседы
+ * @param[in] noise Беседа
+ * @param[in] sample_rate Частота дискретизации, Гц
+ * @return Количество отсчетов до окончания самого длинного звука
+ */
+size_t noiseLength(const syllable::Noise& noise, unsigned sample_rate);
+
+/*!
+ * @brief Запись фрагмента звука беседы
+ * Каждый звук беседы озвучивается синусоидой своей частоты, громкости и длительности, все звуки начинаются
+ * одновременно. Беседа записывается фрагментами, поэтому запись не требует памяти под беседу целиком.
+ * @param[in] noise Беседа
+ * @param[in] sample_rate Частота дискретизации, Гц
+ * @param[in] offset Номер первого отсчета фрагмента от начала беседы
+ * @param[out] samples Отсчеты фрагмента
+ */
+void renderNoise(const syllable::Noise& noise, unsigned sample_rate, size_t offset, std::span<float> samples);
+
 }  // namespace random
 
 }  // namespace animal
@@ -0,0 +1,88 @@
+/*!
+ * @file
+ * @brief Замеры примитивов и стадий обработки устройства, запускаемые командой bench
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "task_pool.h"
+#include <cstddef>
+
+namespace bench {
+
+/*!
+ * @brief Замер очереди команд
+ * Диспетчер ждет команды в блокирующей очереди и, для сравнения, опрашивает ее в цикле, как прежний основной цикл.
+ * Выводится доля ядра, расходуемая процессом, пока команд нет, и задержка от постановки команды до ее получения
+ * диспетчером.
+ * @param[in] commands Количество команд замера задержки
+ */
+void runCommandQueue(size_t commands);
+
+/*!
+ * @brief Замер передачи кадров от окружения к датчикам
+ * Писатель и читатель в разных потоках передают кадры через кольцевой буфер с каждой политикой переполнения и,
+ * для сравнения, через три очереди под общей блокировкой, как до появления единого кадра. Выводится пропускная
+ * способность в кадрах/с, а также задержка пробуждения читателя, ждущего кадр на событии готовности.
+ * @param[in] frames Количество кадров
+ */
+void runFrameRing(size_t frames);
+
+/*!
+ * @brief Замер перевода кадров с распределением животных по пулу потоков
+ * Для каждого количества рабочих потоков и каждого количества животных в кадре переводится одинаковый набор кадров;
+ * сопровождение животных и кэш прогнозов выключены, чтобы каждый кадр переводился целиком.
+ * @param[in] frames Количество кадров для каждого сочетания
+ */
+void runTaskPool(size_t frames);
+
+/*!
+ * @brief Замер классификатора вида
+ * Один и тот же пакет случайных животных классифицируется по одному животному и пакетом каждым набором инструкций,
+ * поддерживаемым процессором. Выводятся классификаций/с и расхождения с поштучной классификацией.
+ * @param[in] animals Количество животных в пакете
+ */
+void runClassifier(size_t animals);
+
+/*!
+ * @brief Замер таблиц признаков видов
+ * Случайные животные генерируются по constexpr-таблицам и, для сравнения, по таким же таблицам в std::map, как до
+ * перехода на массивы; названия животных для монитора так же выбираются из массива и из std::map. Выводятся
+ * животных/с и названий/с для обоих вариантов.
+ * @param[in] animals Количество животных
+ */
+void runTraitTables(size_t animals);
+
+/*!
+ * @brief Замер спектрального анализа звука
+ * Запись нескольких одновременно звучащих животных анализируется при частоте дискретизации 48 и 96 кГц каждой
+ * реализацией стадии звука. Выводятся отсчетов/с, запас по отношению к реальному времени и количество найденных
+ * несущих.
+ * @param[in] pool Пул потоков для многопоточной реализации
+ * @param[in] seconds Длительность записи, с
+ */
+void runSpectrum(concurrency::TaskPool& pool, double seconds);
+
+/*!
+ * @brief Замер построения карты глубины
+ * Кадры со стереопарой 720p и 1080p разделяются на фигуры каждой реализацией стадии видео. Выводятся кадров/с и
+ * среднее количество найденных фигур в кадре.
+ * @param[in] pool Пул потоков для многопоточной реализации
+ * @param[in] frames Количество кадров для каждого разрешения и реализации
+ */
+void runDepthMap(concurrency::TaskPool& pool, size_t frames);
+
+/*!
+ * @brief Проверка того, что обработка кадра не выделяет память
+ * Устройство обрабатывает одни и те же беседы по кругу при прослушивании с последовательной и одновременной
+ * обработкой видео и звука и в потоковом режиме. После разогрева на первом круге считаются выделения памяти во всех
+ * потоках; проверка не пройдена, если хотя бы в одном режиме память выделялась. Вывод на монитор на время
+ * проверки отключается.
+ * @param[in] pool Пул потоков устройства
+ * @param[in] frames Количество кадров для каждого режима после разогрева
+ * @return true, если память не выделялась
+ */
+bool runAllocations(concurrency::TaskPool& pool, size_t frames);
+
+}  // namespace bench
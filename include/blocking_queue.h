@@ -0,0 +1,132 @@
+/*!
+ * @file
+ * @brief Потокобезопасная блокирующая очередь для передачи команд и данных между потоками
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "ring_queue.h"
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+
+namespace concurrency {
+
+/*!
+ * @brief Блокирующая очередь с несколькими писателями и одним (или несколькими) читателями
+ * Читатель засыпает на условной переменной, пока в очереди нет элементов, и не расходует процессорное время.
+ * При заданной емкости писатель так же засыпает, пока в очереди нет свободного места.
+ * Элементы хранятся в кольцевом буфере, поэтому передача элементов через очередь не выделяет память.
+ */
+template <typename T>
+class BlockingQueue {
+public:
+    /*!
+     * @brief Создание очереди
+     * @param[in] capacity Максимальное количество элементов (0 - без ограничения)
+     */
+    explicit BlockingQueue(size_t capacity = 0)
+        : capacity_(capacity),
+          queue_(capacity ? capacity : RingQueue<T>::kInitialCapacity) {}
+
+    BlockingQueue(const BlockingQueue&)            = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    /*!
+     * @brief Добавление элемента в конец очереди с пробуждением ожидающего читателя
+     * Если очередь ограничена и заполнена, вызывающий поток спит до появления свободного места.
+     * @param[in] value Добавляемый элемент
+     * @return false, если очередь закрыта и элемент не добавлен
+     */
+    bool push(T value) {
+        {
+            std::unique_lock lock(mu_);
+            not_full_.wait(lock, [this] { return closed_ || capacity_ == 0 || queue_.size() < capacity_; });
+            if (closed_)
+                return false;
+            queue_.pushBack(std::move(value));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /*!
+     * @brief Извлечение элемента из начала очереди
+     * Вызывающий поток спит, пока очередь пуста.
+     * @return Извлеченный элемент
+     */
+    T pop() {
+        std::unique_lock lock(mu_);
+        not_empty_.wait(lock, [this] { return !queue_.empty(); });
+        return take(lock);
+    }
+
+    /*!
+     * @brief Извлечение элемента из начала очереди с учетом закрытия
+     * Вызывающий поток спит, пока очередь пуста и не закрыта.
+     * @param[out] value Извлеченный элемент
+     * @return false, если очередь закрыта и все элементы из нее уже извлечены
+     */
+    bool pop(T& value) {
+        std::unique_lock lock(mu_);
+        not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty())
+            return false;
+        value = take(lock);
+        return true;
+    }
+
+    /*!
+     * @brief Попытка извлечения элемента без ожидания
+     * @return Извлеченный элемент или пустое значение, если очередь пуста
+     */
+    std::optional<T> tryPop() {
+        std::unique_lock lock(mu_);
+        if (queue_.empty())
+            return std::nullopt;
+        return take(lock);
+    }
+
+    /*!
+     * @brief Закрытие очереди
+     * Новые элементы больше не принимаются, читатели дочитывают оставшиеся и получают признак окончания.
+     */
+    void close() {
+        {
+            std::lock_guard lock(mu_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /// @brief Повторное открытие закрытой очереди
+    void reopen() {
+        std::lock_guard lock(mu_);
+        closed_ = false;
+    }
+
+    /// @brief Количество элементов в очереди на момент вызова
+    size_t size() const {
+        std::lock_guard lock(mu_);
+        return queue_.size();
+    }
+
+private:
+    T take(std::unique_lock<std::mutex>& lock) {
+        T value = queue_.popFront();
+        lock.unlock();
+        not_full_.notify_one();
+        return value;
+    }
+
+    const size_t capacity_;
+    mutable std::mutex mu_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    RingQueue<T> queue_;
+    bool closed_ = false;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,131 @@
+/*!
+ * @file
+ * @brief Построение карты глубины по диспаритету стереопары и разделение фигур на изображении
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include "execution.h"
+#include "task_pool.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace depth {
+
+/// @brief Связная область карты глубины - отдельная фигура на изображении
+struct Component {
+    long area;              ///< Площадь, пиксели
+    double sum_x;           ///< Сумма координат x пикселей (для центра масс)
+    double sum_disparity;   ///< Сумма исправленного диспаритета пикселей
+    unsigned left, right;   ///< Границы по горизонтали (включительно)
+    unsigned top, bottom;   ///< Границы по вертикали (включительно)
+
+    double centerX() const { return sum_x / area; }
+
+    double disparity() const { return sum_disparity / area; }
+};
+
+/*!
+ * @brief Построитель карты глубины
+ * Кадр обрабатывается блоками kTileSize x kTileSize: сначала диспаритет исправляется по показаниям дальномера,
+ * затем в каждом блоке независимо размечаются связные области (соседние пиксели близкой глубины), после чего
+ * области соседних блоков объединяются по их границам. Блок целиком помещается в кэш первого уровня, а
+ * внутренние циклы идут по непрерывным строкам без ветвлений, что позволяет компилятору их векторизовать.
+ * Рабочие буферы переиспользуются между кадрами.
+ * Векторная реализация исправляет диспаритет инструкциями AVX2 по 32 пикселя, многопоточная дополнительно
+ * распределяет полосы строк и разметку блоков по пулу потоков.
+ */
+class DepthMapper {
+public:
+    /*!
+     * @brief Создание построителя
+     * @param[in] pool Пул потоков для многопоточной реализации (nullptr - многопоточная реализация недоступна)
+     */
+    explicit DepthMapper(concurrency::TaskPool* pool = nullptr) : pool_(pool) {}
+
+    /*!
+     * @brief Построение карты глубины с поправкой на расстояние
+     * Ошибка калибровки диспаритета определяется по центральному пикселю кадра, расстояние до которого измерено
+     * дальномером. Если центральный пиксель - фон, поправка не применяется.
+     * @param[in] video Кадр видео с картой диспаритета
+     * @param[in] distance Расстояние до центрального пикселя, м (0 - не измерено)
+     * @param[in] backend Реализация построения и разделения этого кадра
+     */
+    void build(const pantomime::VideoView& video, double distance,
+               execution::Backend backend = execution::kScalar);
+
+    /*!
+     * @brief Разделение карты глубины на связные области
+     * @return Найденные области площадью не менее kMinArea; данные действительны до следующего вызова build()
+     */
+    std::span<const Component> segment();
+
+    /// @brief Расстояние до области, м
+    double depth(const Component& component) const;
+
+    /// @brief Высота области в реальном масштабе, см
+    double size(const Component& component) const;
+
+    unsigned width() const { return width_; }
+
+    unsigned height() const { return height_; }
+
+    /// @brief Поправка диспаритета, определенная по дальномеру
+    int bias() const { return bias_; }
+
+    /// @brief Размер стороны блока обработки, пиксели
+    static constexpr unsigned kTileSize = 64;
+    /// @brief Минимальный диспаритет переднего плана (дальше kFocalLength * kStereoBaseline / 16 = 50 м - фон)
+    static constexpr uint8_t kMinDisparity = 16;
+    /// @brief Максимальная разница диспаритета соседних пикселей одной фигуры
+    static constexpr uint8_t kDepthStep = 2;
+    /// @brief Минимальная площадь фигуры, пиксели (меньшие области считаются шумом)
+    static constexpr long kMinArea = 16;
+
+private:
+    /// @brief Исправление диспаритета и отделение фона
+    void correct(std::span<const uint8_t> disparity);
+
+    /*!
+     * @brief Разметка связных областей внутри блока
+     * @param[in,out] parent Лес меток, в который добавляются новые метки блока
+     */
+    void labelTile(unsigned x0, unsigned y0, unsigned x1, unsigned y1, std::vector<int32_t>& parent);
+
+    /// @brief Разметка всех блоков в пуле потоков с переводом меток блоков в общую нумерацию
+    void labelTilesParallel();
+
+    /// @brief Объединение областей соседних блоков по их границам
+    void mergeTiles();
+
+    /// @brief Пиксели принадлежат одной фигуре
+    bool connected(size_t first, size_t second) const;
+
+    static int32_t find(std::vector<int32_t>& parent, int32_t label);
+
+    static void unite(std::vector<int32_t>& parent, int32_t first, int32_t second);
+
+    concurrency::TaskPool* pool_;
+    execution::Backend backend_ = execution::kScalar;
+
+    unsigned width_  = 0;
+    unsigned height_ = 0;
+    int bias_        = 0;
+    /// @brief Исправленный диспаритет, 0 - фон
+    std::vector<uint8_t> disparity_;
+    /// @brief Метка области каждого пикселя, 0 - фон
+    std::vector<int32_t> labels_;
+    /// @brief Лес непересекающихся множеств меток
+    std::vector<int32_t> parent_;
+    /// @brief Номер области для корневой метки
+    std::vector<int32_t> compact_;
+    /// @brief Леса меток блоков и сдвиги их меток в общей нумерации (многопоточная разметка)
+    std::vector<std::vector<int32_t>> tile_parents_;
+    std::vector<int32_t> tile_offsets_;
+    std::vector<Component> components_;
+};
+
+}  // namespace depth
@@ -0,0 +1,136 @@
+/*!
+ * @file
+ * @brief Узел, на котором работает много независимых устройств-переводчиков с общим пулом потоков
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "blocking_queue.h"
+#include "frame_bus.h"
+#include "readiness_event.h"
+#include "task_pool.h"
+#include "translator.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+/// @brief Итоги работы устройства на узле
+struct DeviceStats {
+    unsigned priority;  ///< Приоритет (вес) устройства
+    size_t frames;      ///< Количество обработанных кадров
+    size_t animals;     ///< Количество переведенных животных
+};
+
+/*!
+ * @brief Узел с множеством устройств
+ * У каждого устройства собственные потоки данных и собственное состояние (питание, режимы обработки), но
+ * собственных потоков у устройств нет. Единственный поток планировщика ждет событий готовности всех устройств
+ * через epoll и раздает работу общему пулу потоков по алгоритму взвешенного кругового обслуживания с дефицитом
+ * (deficit round robin): за каждый круг устройство может обработать не больше kQuantum * приоритет кадров, а
+ * неизрасходованный остаток переносится на следующий круг, пока у устройства есть кадры. Одно устройство никогда
+ * не обрабатывается двумя потоками одновременно, а в работе одновременно не больше задач, чем потоков в пуле,
+ * поэтому порядок обслуживания определяет планировщик, а не очередь пула.
+ */
+class DeviceHost {
+public:
+    /*!
+     * @brief Создание узла
+     * @param[in] pool Общий пул потоков
+     */
+    explicit DeviceHost(concurrency::TaskPool& pool);
+
+    ~DeviceHost();
+
+    DeviceHost(const DeviceHost&)            = delete;
+    DeviceHost& operator=(const DeviceHost&) = delete;
+
+    /*!
+     * @brief Добавление включенного устройства (до запуска узла)
+     * @param[in] priority Приоритет устройства - его доля в обслуживании, не меньше 1
+     * @return Номер устройства
+     */
+    size_t addDevice(unsigned priority);
+
+    /// @brief Шина входных кадров устройства (запись допускается только из одного потока)
+    animal::FrameRing& input(size_t device) { return devices_[device]->frames.lane(0); }
+
+    /// @brief Оповещение устройства о поступлении кадров
+    void notify(size_t device) { devices_[device]->ready.notify(); }
+
+    size_t size() const { return devices_.size(); }
+
+    void start();
+
+    /// @brief Остановка планировщика; ожидает завершения выданных пулу задач
+    void stop();
+
+    std::vector<DeviceStats> stats() const;
+
+    /// @brief Количество кадров, обрабатываемых устройством единичного приоритета за круг
+    static constexpr size_t kQuantum = 4;
+    /// @brief Емкость входной полосы устройства
+    static constexpr size_t kInputCapacity = 32;
+
+private:
+    struct Device {
+        Device(concurrency::TaskPool& pool, unsigned priority);
+
+        concurrency::ReadinessEvent ready;
+        animal::FrameBus frames;
+        /// @brief Поток микрофона устройства (в режиме узла звук передается в предзаготовленном виде)
+        animal::AudioRing audio;
+        translator::AnimalTranslatinator translator;
+        const unsigned priority;
+        /// @brief Состояние планирования, изменяется только потоком планировщика
+        size_t deficit = 0;
+        bool queued    = false;
+        bool busy      = false;
+        /// @brief Количество кадров, обработанных последней задачей
+        size_t served = 0;
+        std::atomic<size_t> frames_done{0};
+        std::atomic<size_t> animals_done{0};
+    };
+
+    /// @brief Цикл планировщика
+    void schedule();
+
+    /// @brief Постановка устройства в очередь обслуживания
+    void enqueue(Device& device);
+
+    /// @brief Выдача задач пулу по кругу, пока в пуле есть свободные потоки
+    void dispatch();
+
+    /// @brief Учет завершенной задачи устройства
+    void complete(Device& device);
+
+    concurrency::TaskPool& pool_;
+    std::vector<std::unique_ptr<Device>> devices_;
+    /// @brief Устройства, ожидающие обслуживания, в порядке круга
+    std::deque<Device*> active_;
+    /// @brief Устройства, задачи которых завершились
+    concurrency::BlockingQueue<Device*> completed_;
+    /// @brief Событие пробуждения планировщика при завершении задач и остановке
+    concurrency::ReadinessEvent wakeup_;
+    std::thread scheduler_;
+    std::atomic<bool> running_{false};
+    size_t in_flight_ = 0;
+    int epoll_fd_     = -1;
+};
+
+/*!
+ * @brief Замер масштабируемости узла
+ * Узел с заданным количеством устройств (приоритеты 1..4 по кругу) нагружается несколькими потоками-источниками,
+ * которые держат входы всех устройств заполненными. Выводится общая пропускная способность и доля обслуживания
+ * устройств каждого приоритета.
+ * @param[in] pool Общий пул потоков
+ * @param[in] device_count Количество устройств
+ * @param[in] seconds Длительность замера, с
+ */
+void runBenchmark(concurrency::TaskPool& pool, size_t device_count, double seconds);
+
+}  // namespace host
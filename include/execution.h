@@ -0,0 +1,96 @@
+/*!
+ * @file
+ * @brief Исполнение стадий обработки: выбор реализации (скалярной, SIMD, многопоточной) для каждой стадии
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string_view>
+
+namespace execution {
+
+/// @brief Стадии обработки с заменяемым исполнением
+enum Stage {
+    kVideo = 0,  ///< Карта глубины и разделение фигур
+    kAudio,      ///< Спектральный анализ звука
+    kClassify,   ///< Классификация животных
+    kDecode,     ///< Настроение, потребность и сообщение
+    kMaxStage,
+};
+
+/// @brief Реализация стадии
+enum Backend {
+    kScalar = 0,  ///< Последовательная скалярная реализация
+    kSimd,        ///< Векторные инструкции процессора в одном потоке
+    kThreaded,    ///< Обработка частями в общем пуле потоков, части обрабатываются векторными инструкциями
+    kMaxBackend,
+};
+
+inline constexpr std::array<const char*, kMaxStage> kStageNames = {"video", "audio", "classify", "decode"};
+
+inline constexpr std::array<const char*, kMaxBackend> kBackendNames = {"scalar", "simd", "threaded"};
+
+/*!
+ * @brief Поддержка процессором AVX2 и FMA, на которых построены векторные реализации стадий
+ * Проверка выполняется один раз при первом вызове.
+ */
+inline bool hasAvx2() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * @brief Выбранные реализации стадий устройства
+ * Реализация стадии читается один раз в начале обработки кадра, поэтому замена вступает в силу со следующего кадра
+ * и не требует остановки обработки. Если для стадии нет векторной реализации или процессор не поддерживает нужные
+ * инструкции, используется скалярная.
+ */
+class Backends {
+public:
+    Backends() {
+        backends_[kVideo].store(kScalar, std::memory_order_relaxed);
+        backends_[kAudio].store(kScalar, std::memory_order_relaxed);
+        backends_[kClassify].store(kSimd, std::memory_order_relaxed);
+        backends_[kDecode].store(kThreaded, std::memory_order_relaxed);
+    }
+
+    Backends(const Backends&)            = delete;
+    Backends& operator=(const Backends&) = delete;
+
+    Backend get(Stage stage) const { return backends_[stage].load(std::memory_order_relaxed); }
+
+    void set(Stage stage, Backend backend) { backends_[stage].store(backend, std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<Backend>, kMaxStage> backends_;
+};
+
+/// @brief Поиск стадии по названию; kMaxStage, если такой нет
+inline Stage parseStage(std::string_view name) {
+    for (size_t stage = 0; stage < kMaxStage; stage++) {
+        if (name == kStageNames[stage])
+            return static_cast<Stage>(stage);
+    }
+    return kMaxStage;
+}
+
+/// @brief Поиск реализации по названию; kMaxBackend, если такой нет
+inline Backend parseBackend(std::string_view name) {
+    for (size_t backend = 0; backend < kMaxBackend; backend++) {
+        if (name == kBackendNames[backend])
+            return static_cast<Backend>(backend);
+    }
+    return kMaxBackend;
+}
+
+}  // namespace execution
@@ -0,0 +1,125 @@
+/*!
+ * @file
+ * @brief Пакеты признаков пантомимики и звука в виде структуры массивов
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pantomime {
+
+/*!
+ * @brief Пакет пантомимики в виде структуры массивов
+ * Каждый признак хранится в отдельном плотном массиве, перечисления упакованы в один байт.
+ * Запись занимает 7 байт вместо 24 у Pantomime, а циклы по одному признаку векторизуются.
+ */
+struct PantomimeBatch {
+    std::vector<uint8_t> facial;
+    std::vector<uint8_t> body;
+    std::vector<uint8_t> gestures;
+    std::vector<int32_t> size;
+
+    size_t count() const { return size.size(); }
+
+    void clear() {
+        facial.clear();
+        body.clear();
+        gestures.clear();
+        size.clear();
+    }
+
+    void reserve(size_t capacity) {
+        facial.reserve(capacity);
+        body.reserve(capacity);
+        gestures.reserve(capacity);
+        size.reserve(capacity);
+    }
+
+    /// @brief Добавление записи из структуры
+    void push_back(const Pantomime& pantomime) {
+        facial.push_back(static_cast<uint8_t>(pantomime.facial));
+        body.push_back(static_cast<uint8_t>(pantomime.body));
+        gestures.push_back(static_cast<uint8_t>(pantomime.gestures));
+        size.push_back(static_cast<int32_t>(pantomime.size));
+    }
+
+    /// @brief Добавление всех записей массива структур
+    void append(std::span<const Pantomime> figures) {
+        reserve(count() + figures.size());
+        for (const Pantomime& pantomime : figures) push_back(pantomime);
+    }
+
+    /// @brief Восстановление записи в виде структуры
+    Pantomime at(size_t iter) const {
+        return (Pantomime){.facial   = static_cast<FacialExpression>(facial[iter]),
+                           .body     = static_cast<BodyPosition>(body[iter]),
+                           .gestures = static_cast<Gesture>(gestures[iter]),
+                           .size     = size[iter]};
+    }
+};
+
+}  // namespace pantomime
+
+namespace syllable {
+
+/*!
+ * @brief Пакет звуков в виде структуры массивов
+ * Запись занимает 12 байт вместо 32 у Sound: перечисления упакованы в один байт, частота и длительность
+ * хранятся с одинарной точностью, громкость - 16-битным целым.
+ */
+struct SoundBatch {
+    std::vector<uint8_t> larinx;
+    std::vector<uint8_t> throat;
+    std::vector<float> frequency;
+    std::vector<uint16_t> volume;
+    std::vector<float> duration;
+
+    size_t count() const { return volume.size(); }
+
+    void clear() {
+        larinx.clear();
+        throat.clear();
+        frequency.clear();
+        volume.clear();
+        duration.clear();
+    }
+
+    void reserve(size_t capacity) {
+        larinx.reserve(capacity);
+        throat.reserve(capacity);
+        frequency.reserve(capacity);
+        volume.reserve(capacity);
+        duration.reserve(capacity);
+    }
+
+    /// @brief Добавление записи из структуры
+    void push_back(const Sound& sound) {
+        larinx.push_back(static_cast<uint8_t>(sound.larinx));
+        throat.push_back(static_cast<uint8_t>(sound.throat));
+        frequency.push_back(static_cast<float>(sound.frequency));
+        volume.push_back(static_cast<uint16_t>(sound.volume));
+        duration.push_back(static_cast<float>(sound.duration));
+    }
+
+    /// @brief Добавление всех записей массива структур
+    void append(std::span<const Sound> noises) {
+        reserve(count() + noises.size());
+        for (const Sound& sound : noises) push_back(sound);
+    }
+
+    /// @brief Восстановление записи в виде структуры
+    Sound at(size_t iter) const {
+        return (Sound){.larinx    = static_cast<LarynxSound>(larinx[iter]),
+                       .throat    = static_cast<ThroatSound>(throat[iter]),
+                       .frequency = frequency[iter],
+                       .volume    = volume[iter],
+                       .duration  = duration[iter]};
+    }
+};
+
+}  // namespace syllable
@@ -0,0 +1,91 @@
+/*!
+ * @file
+ * @brief Шина кадров: несколько независимых источников кадров для одного читателя
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include "readiness_event.h"
+#include <memory>
+#include <vector>
+
+namespace animal {
+
+/*!
+ * @brief Шина кадров
+ * Каждый источник кадров (окружение, потоки генератора нагрузки) пишет в собственную полосу - кольцевой буфер
+ * для одного писателя и одного читателя, поэтому источники не конкурируют между собой. Датчики читают полосы
+ * по кругу и ждут поступления кадров на общем событии готовности.
+ */
+class FrameBus {
+public:
+    /*!
+     * @brief Создание шины без полос
+     * @param[in] ready Событие готовности, взводимое источниками после публикации кадра
+     */
+    explicit FrameBus(concurrency::ReadinessEvent& ready) : ready_(ready) {}
+
+    FrameBus(const FrameBus&)            = delete;
+    FrameBus& operator=(const FrameBus&) = delete;
+
+    /*!
+     * @brief Добавление полосы
+     * Полосы добавляются при настройке шины, до того как источники и датчики начнут работу.
+     * @param[in] capacity Емкость полосы, степень двойки
+     * @param[in] policy Поведение источника при заполненной полосе
+     * @return Номер полосы
+     */
+    size_t addLane(size_t capacity, concurrency::OverflowPolicy policy = concurrency::OverflowPolicy::kDropOldest) {
+        lanes_.push_back(std::make_unique<FrameRing>(capacity, policy));
+        return lanes_.size() - 1;
+    }
+
+    /// @brief Полоса источника (запись в полосу допускается только из одного потока)
+    FrameRing& lane(size_t index) { return *lanes_[index]; }
+
+    size_t laneCount() const { return lanes_.size(); }
+
+    concurrency::ReadinessEvent& ready() { return ready_; }
+
+    /*!
+     * @brief Извлечение кадра без ожидания (вызывается только потоком-читателем)
+     * Полосы опрашиваются по кругу начиная со следующей за последней прочитанной, чтобы ни один источник не
+     * вытеснял остальные.
+     * @param[out] frame Извлеченный кадр
+     * @return false, если все полосы пусты
+     */
+    bool tryPop(Frame& frame) {
+        for (size_t iter = 0; iter < lanes_.size(); iter++) {
+            const size_t lane = (next_ + iter) % lanes_.size();
+            if (lanes_[lane]->tryPop(frame)) {
+                next_ = lane + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Суммарное количество кадров во всех полосах
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& lane : lanes_) total += lane->size();
+        return total;
+    }
+
+    /// @brief Суммарное количество кадров, вытесненных из переполненных полос
+    size_t dropped() const {
+        size_t total = 0;
+        for (const auto& lane : lanes_) total += lane->dropped();
+        return total;
+    }
+
+private:
+    concurrency::ReadinessEvent& ready_;
+    std::vector<std::unique_ptr<FrameRing>> lanes_;
+    /// @brief Полоса, с которой начнется следующий опрос
+    size_t next_ = 0;
+};
+
+}  // namespace animal
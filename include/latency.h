@@ -0,0 +1,165 @@
+/*!
+ * @file
+ * @brief Измерение длительности стадий обработки: интервалы по монотонным часам и гистограммы задержек
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace latency {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief Измеряемые стадии обработки
+enum Stage {
+    kCollect = 0,     ///< Ожидание кадра от датчиков
+    kPrepare,         ///< Обработка первичных данных (видео и звук вместе)
+    kVideo,           ///< Разбор видео
+    kAudio,           ///< Разбор звука
+    kClassify,        ///< Классификация животного
+    kNeed,            ///< Определение настроения и потребности
+    kMessage,         ///< Подготовка сообщения
+    kTranslateBatch,  ///< Пакетный перевод
+    kDisplay,         ///< Вывод на монитор
+    kListen,          ///< Обработка беседы по кнопке прослушивания целиком, без ожидания кадра
+    kMaxStage,
+};
+
+/// @brief Названия стадий для вывода статистики
+inline constexpr std::array<const char*, kMaxStage> kStageNames = {
+    "ожидание кадра", "подготовка", "видео", "звук", "классификация", "потребность", "сообщение", "пакетный перевод",
+    "монитор", "прослушивание"};
+
+/*!
+ * @brief Гистограмма задержек с логарифмически-линейными интервалами (как в HdrHistogram)
+ * Каждая степень двойки наносекунд разбита на kSubBuckets равных интервалов, поэтому относительная погрешность
+ * значения не превышает 1 / kSubBuckets при постоянном объеме памяти. В гистограмму пишет только поток-владелец,
+ * а читать ее может любой поток без блокировок.
+ */
+class Histogram {
+public:
+    /// @brief Количество двоичных разрядов точности
+    static constexpr unsigned kSubBits    = 5;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBits;
+    /// @brief Наибольшее различимое значение, 2^40 нс (около 18 минут); большие значения учитываются в нем
+    static constexpr unsigned kMaxBits = 40;
+    static constexpr size_t kBuckets   = (kMaxBits - kSubBits + 1) << kSubBits;
+
+    /// @brief Учет значения (вызывается только потоком-владельцем)
+    void record(uint64_t ns) {
+        auto& count = counts_[index(ns)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    }
+
+    uint64_t count(size_t bucket) const { return counts_[bucket].load(std::memory_order_relaxed); }
+
+    /// @brief Сумма учтенных значений, нс
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    /// @brief Номер интервала значения
+    static size_t index(uint64_t ns) {
+        ns = std::min<uint64_t>(ns, (1ull << kMaxBits) - 1);
+        if (ns < kSubBuckets)
+            return ns;
+        const unsigned shift = std::bit_width(ns) - 1 - kSubBits;
+        return ((size_t)(shift + 1) << kSubBits) | ((ns >> shift) & (kSubBuckets - 1));
+    }
+
+    /// @brief Наибольшее значение интервала, нс
+    static uint64_t highest(size_t bucket) {
+        if (bucket < 2 * kSubBuckets)
+            return bucket;
+        const unsigned shift = (bucket >> kSubBits) - 1;
+        return (((bucket & (kSubBuckets - 1)) | kSubBuckets) << shift) + (1ull << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+    std::atomic<uint64_t> sum_{0};
+};
+
+/*!
+ * @brief Учет длительности стадии
+ * Гистограммы ведутся отдельно для каждого потока и объединяются только при построении статистики, поэтому
+ * потоки не делят между собой ни блокировок, ни кэш-линий.
+ * @param[in] stage Стадия
+ * @param[in] ns Длительность, нс
+ */
+void record(Stage stage, uint64_t ns);
+
+/*!
+ * @brief Закрепление гистограмм за текущим потоком
+ * Гистограммы потока создаются при первом измерении; поток, который начинает измерения не сразу (например, рабочий
+ * поток пула), закрепляет их заранее, чтобы первое измерение не выделяло память посреди обработки кадра.
+ */
+void attachThread();
+
+/*!
+ * @brief Интервал измерения стадии
+ * Длительность учитывается при вызове stop() или при уничтожении интервала.
+ */
+class Span {
+public:
+    explicit Span(Stage stage) : stage_(stage), start_(Clock::now()) {}
+
+    ~Span() { stop(); }
+
+    Span(const Span&)            = delete;
+    Span& operator=(const Span&) = delete;
+
+    /*!
+     * @brief Окончание интервала
+     * @return Длительность интервала, с; повторный вызов возвращает ту же длительность
+     */
+    double stop() {
+        if (!stopped_) {
+            stopped_ = true;
+            elapsed_ = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+            record(stage_, elapsed_);
+        }
+        return elapsed_ * 1e-9;
+    }
+
+private:
+    Stage stage_;
+    Clock::time_point start_;
+    uint64_t elapsed_ = 0;
+    bool stopped_     = false;
+};
+
+/// @brief Статистика стадии, мкс
+struct Summary {
+    uint64_t count;
+    double mean;
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+/// @brief Статистика всех стадий по всем потокам с момента последнего сброса
+std::array<Summary, kMaxStage> summarize();
+
+/// @brief Сброс статистики; гистограммы потоков при этом не изменяются
+void reset();
+
+/// @brief Вывод статистики стадий
+void print();
+
+/*!
+ * @brief Выгрузка статистики стадий в файл CSV
+ * @param[in] path Путь к файлу
+ * @return false, если файл не удалось записать
+ */
+bool exportCsv(const std::string& path);
+
+}  // namespace latency
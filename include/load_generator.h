@@ -0,0 +1,86 @@
+/*!
+ * @file
+ * @brief Генератор синтетической нагрузки для проверки пропускной способности переводчика
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "frame_bus.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace reactor {
+
+/// @brief Параметры нагрузки
+struct LoadProfile {
+    size_t producers         = 1;     ///< Количество потоков-источников
+    double frames_per_second = 0;     ///< Суммарная частота кадров всех источников (0 - без ограничения)
+    size_t min_animals       = 1;     ///< Минимальное количество животных в кадре
+    size_t max_animals       = 3;     ///< Максимальное количество животных в кадре
+    double duration          = 10;    ///< Длительность нагрузки, с
+    uint64_t seed            = 1;     ///< Зерно генераторов; источник i использует зерно seed + i
+    bool render_video        = true;  ///< Снимать беседы стереокамерой (карта диспаритета в каждом кадре)
+    double persistence       = 0;     ///< Вероятность того, что животное прошлого кадра осталось в кадре неизменным
+};
+
+/*!
+ * @brief Генератор синтетической нагрузки
+ * Каждый источник работает в собственном потоке с собственным генератором псевдослучайных чисел и пишет в
+ * собственную полосу шины кадров, поэтому источники не синхронизируются друг с другом. При одинаковом зерне
+ * источники воспроизводят одинаковые последовательности кадров. Звук бесед в режиме нагрузки не записывается,
+ * звуки передаются в предзаготовленном виде.
+ */
+class LoadGenerator {
+public:
+    /*!
+     * @brief Создание генератора
+     * @param[in] bus Шина кадров
+     * @param[in] first_lane Номер первой полосы шины, отданной генератору; остальные полосы до конца шины
+     * так же принадлежат генератору
+     */
+    LoadGenerator(animal::FrameBus& bus, size_t first_lane) : bus_(bus), first_lane_(first_lane) {}
+
+    ~LoadGenerator() { stop(); }
+
+    /*!
+     * @brief Запуск нагрузки
+     * @param[in] profile Параметры нагрузки
+     * @return false, если нагрузка уже запущена или параметры недопустимы
+     */
+    bool start(const LoadProfile& profile);
+
+    /// @brief Досрочная остановка нагрузки
+    void stop();
+
+    bool running() const { return active_.load(std::memory_order_acquire) > 0; }
+
+    /// @brief Максимальное количество источников
+    size_t maxProducers() const { return bus_.laneCount() - first_lane_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Цикл источника
+    void produce(size_t producer);
+
+    /// @brief Вывод итогов нагрузки
+    void report() const;
+
+    animal::FrameBus& bus_;
+    const size_t first_lane_;
+    LoadProfile profile_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stopping_{false};
+    /// @brief Количество работающих источников
+    std::atomic<size_t> active_{0};
+    std::atomic<size_t> produced_{0};
+    std::atomic<size_t> animals_{0};
+    size_t dropped_at_start_ = 0;
+    Clock::time_point start_;
+};
+
+}  // namespace reactor
@@ -0,0 +1,169 @@
+/*!
+ * @file
+ * @brief Ограниченный потокобезопасный кэш результатов чистых функций
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace concurrency {
+
+/*!
+ * @brief Кэш результатов по 64-битному ключу с ограниченным количеством записей
+ * Ключи распределяются по kShards сегментам, у каждого сегмента своя блокировка, поэтому потоки пула редко
+ * ожидают друг друга. Сегмент - множественно-ассоциативная таблица: ключ может лежать только в одном наборе
+ * из kWays записей, а при заполнении набора вытесняется запись, к которой дольше всего не обращались.
+ * Память выделяется один раз при создании кэша.
+ */
+template <typename Value>
+class MemoCache {
+public:
+    /// @brief Счетчики обращений к кэшу
+    struct Stats {
+        uint64_t hits;       ///< Результат найден в кэше
+        uint64_t misses;     ///< Результата в кэше нет
+        uint64_t evictions;  ///< Вытеснено записей при добавлении
+        size_t size;         ///< Занято записей
+        size_t capacity;     ///< Всего записей
+    };
+
+    /*!
+     * @brief Создание кэша
+     * @param[in] capacity Количество записей; округляется вверх до степени двойки не меньше kShards * kWays
+     */
+    explicit MemoCache(size_t capacity)
+        : sets_(std::bit_ceil(std::max<size_t>(capacity, kShards * kWays)) / (kShards * kWays)) {
+        for (Shard& shard : shards_) shard.entries.resize(sets_ * kWays);
+    }
+
+    MemoCache(const MemoCache&)            = delete;
+    MemoCache& operator=(const MemoCache&) = delete;
+
+    /*!
+     * @brief Поиск результата
+     * @param[in] key Ключ
+     * @param[out] value Найденный результат
+     * @return false, если результата в кэше нет
+     */
+    bool find(uint64_t key, Value& value) {
+        const uint64_t hash = mix(key);
+        Shard& shard        = shards_[hash % kShards];
+        std::lock_guard lock(shard.mu);
+        Entry* set = shard.entries.data() + (hash / kShards & (sets_ - 1)) * kWays;
+        for (size_t way = 0; way < kWays; way++) {
+            if (set[way].used && set[way].key == key) {
+                set[way].used = ++shard.clock;
+                value         = set[way].value;
+                shard.hits++;
+                return true;
+            }
+        }
+        shard.misses++;
+        return false;
+    }
+
+    /*!
+     * @brief Добавление результата
+     * Если ключ уже есть (его добавил другой поток), результат заменяется.
+     * @param[in] key Ключ
+     * @param[in] value Результат
+     */
+    void insert(uint64_t key, const Value& value) {
+        const uint64_t hash = mix(key);
+        Shard& shard        = shards_[hash % kShards];
+        std::lock_guard lock(shard.mu);
+        Entry* set    = shard.entries.data() + (hash / kShards & (sets_ - 1)) * kWays;
+        Entry* victim = set;
+        for (size_t way = 0; way < kWays; way++) {
+            if (set[way].used && set[way].key == key) {
+                victim = &set[way];
+                break;
+            }
+            // Свободная запись (used = 0) выбирается раньше занятых
+            if (set[way].used < victim->used)
+                victim = &set[way];
+        }
+        if (victim->used && victim->key != key)
+            shard.evictions++;
+        *victim = (Entry){.key = key, .used = ++shard.clock, .value = value};
+    }
+
+    /*!
+     * @brief Результат из кэша или вычисленный и добавленный в кэш
+     * Вычисление выполняется без блокировки, поэтому два потока могут одновременно вычислить один результат.
+     * @param[in] key Ключ
+     * @param[in] compute Вычисление результата
+     */
+    template <typename Compute>
+    Value getOrCompute(uint64_t key, Compute&& compute) {
+        Value value;
+        if (find(key, value))
+            return value;
+        value = compute();
+        insert(key, value);
+        return value;
+    }
+
+    Stats stats() {
+        Stats stats{.capacity = kShards * sets_ * kWays};
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mu);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            for (const Entry& entry : shard.entries) stats.size += entry.used != 0;
+        }
+        return stats;
+    }
+
+    /// @brief Удаление всех записей и сброс счетчиков
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mu);
+            for (Entry& entry : shard.entries) entry.used = 0;
+            shard.hits = shard.misses = shard.evictions = 0;
+        }
+    }
+
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kWays   = 4;
+
+private:
+    struct Entry {
+        uint64_t key;
+        /// @brief Время последнего обращения по часам сегмента; 0 - запись свободна
+        uint64_t used = 0;
+        Value value;
+    };
+
+    /// @brief Сегмент кэша; выровнен по линии кэша, чтобы блокировки соседних сегментов не мешали друг другу
+    struct alignas(64) Shard {
+        std::mutex mu;
+        std::vector<Entry> entries;
+        uint64_t clock     = 0;
+        uint64_t hits      = 0;
+        uint64_t misses    = 0;
+        uint64_t evictions = 0;
+    };
+
+    /// @brief Перемешивание битов ключа (финализатор SplitMix64), чтобы близкие ключи попадали в разные наборы
+    static uint64_t mix(uint64_t key) {
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+        return key ^ (key >> 31);
+    }
+
+    /// @brief Количество наборов в сегменте, степень двойки
+    const size_t sets_;
+    std::array<Shard, kShards> shards_;
+};
+
+}  // namespace concurrency
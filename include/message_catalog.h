@@ -0,0 +1,100 @@
+/*!
+ * @file
+ * @brief Каталог сообщений переводчика: тексты шаблонов языковых конструкций на всех поддерживаемых языках
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace messages {
+
+/// @brief Шаблон человеческой языковой конструкции
+enum Template : uint16_t {
+    kGoulash = 0,
+    kLorem,
+    kAfraid,
+    kPlay,
+    kMaxTemplate,
+};
+
+/// @brief Названия шаблонов в файле каталога
+inline constexpr std::array<const char*, kMaxTemplate> kTemplateNames = {"goulash", "lorem", "afraid", "play"};
+
+/// @brief Номер языка в каталоге
+using Locale = uint16_t;
+
+/// @brief Язык, отсутствующий в каталоге
+inline constexpr Locale kNoLocale = UINT16_MAX;
+
+/// @brief Тексты всех шаблонов на одном языке
+struct LocaleTexts {
+    std::string name;
+    std::array<std::string, kMaxTemplate> texts;
+};
+
+/*!
+ * @brief Неизменяемый каталог сообщений
+ * Тексты хранятся в одном буфере, одинаковые тексты разных языков - один раз. Таблица [язык][шаблон] хранит
+ * ссылки в этот буфер, поэтому выбор сообщения - одно чтение из таблицы. Каталог один на процесс и не зависит
+ * от количества устройств.
+ */
+class Catalog {
+public:
+    /*!
+     * @brief Создание каталога
+     * @param[in] locales Тексты всех языков
+     * @param[in] generation Номер каталога: 0 - встроенный, загруженные каталоги нумеруются по порядку загрузки
+     */
+    explicit Catalog(const std::vector<LocaleTexts>& locales, uint32_t generation = 0);
+
+    Catalog(const Catalog&)            = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    std::string_view message(Locale locale, Template message_template) const {
+        return table_[(size_t)locale * kMaxTemplate + message_template];
+    }
+
+    size_t locales() const { return names_.size(); }
+
+    std::string_view localeName(Locale locale) const { return names_[locale]; }
+
+    /// @brief Поиск языка по названию; kNoLocale, если такого нет
+    Locale findLocale(std::string_view name) const;
+
+    /// @brief Размер буфера текстов, байты
+    size_t bytes() const { return text_.size(); }
+
+    /// @brief Номер каталога; по его изменению пользователи каталога узнают о замене текущего каталога
+    uint32_t generation() const { return generation_; }
+
+private:
+    uint32_t generation_;
+    std::string text_;
+    std::vector<std::string_view> names_;
+    std::vector<std::string_view> table_;
+};
+
+/*!
+ * @brief Текущий каталог процесса
+ * До загрузки каталога из файла используется встроенный каталог с языками ru и en.
+ */
+const Catalog& current();
+
+/*!
+ * @brief Загрузка каталога из текстового файла и замена им текущего
+ * Файл состоит из блоков "locale <название>", за которыми следуют строки "<шаблон> = <текст>" в UTF-8 для всех
+ * шаблонов; пустые строки и строки, начинающиеся с '#', пропускаются. Прежние каталоги не освобождаются, так как
+ * на их тексты ссылаются уже переведенные сообщения, поэтому замена не требует блокировок.
+ * @param[in] path Путь к файлу
+ * @param[out] error Описание ошибки разбора
+ * @return false, если файл не удалось прочитать или он содержит ошибки; текущий каталог при этом не меняется
+ */
+bool load(const std::string& path, std::string& error);
+
+}  // namespace messages
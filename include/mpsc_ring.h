@@ -0,0 +1,125 @@
+/*!
+ * @file
+ * @brief Ограниченный кольцевой буфер без блокировок для нескольких писателей и одного читателя
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "spsc_ring.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace concurrency {
+
+/*!
+ * @brief Кольцевой буфер фиксированного размера, в который пишут несколько потоков, а читает один
+ * Писатели захватывают позицию записи через CAS и заполняют свою ячейку независимо друг от друга; ячейка становится
+ * видна читателю после публикации ее номера последовательности. Если буфер заполнен, писатель спит до освобождения
+ * места, поэтому элементы не теряются. Память под элементы выделяется один раз при создании буфера.
+ */
+template <typename T>
+class MpscRing {
+public:
+    /*!
+     * @brief Создание кольцевого буфера
+     * @param[in] capacity Емкость буфера, должна быть степенью двойки
+     */
+    explicit MpscRing(size_t capacity)
+        : capacity_(capacity),
+          mask_(capacity - 1),
+          slots_(std::make_unique<Slot[]>(capacity)) {
+        if (capacity == 0 || (capacity & mask_) != 0)
+            throw std::invalid_argument("MpscRing capacity must be a power of two");
+        for (size_t iter = 0; iter < capacity_; iter++) slots_[iter].seq.store(iter, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&)            = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /*!
+     * @brief Запись элемента (вызывается любым потоком)
+     * Писатель спит, пока в буфере нет свободной ячейки.
+     * @param[in] value Записываемый элемент
+     * @return Порядковый номер элемента в потоке, начиная с 1
+     */
+    size_t push(const T& value) {
+        size_t pos = head_.value.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot     = slots_[pos & mask_];
+            const auto seq = static_cast<std::ptrdiff_t>(slot.seq.load(std::memory_order_acquire) - pos);
+            if (seq == 0) {
+                if (head_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (seq < 0) {
+                // Буфер заполнен: ждем, пока читатель освободит ячейку
+                const size_t tail = tail_.value.load(std::memory_order_acquire);
+                if (pos - tail >= capacity_)
+                    tail_.value.wait(tail, std::memory_order_acquire);
+                pos = head_.value.load(std::memory_order_relaxed);
+            } else {
+                pos = head_.value.load(std::memory_order_relaxed);
+            }
+        }
+        Slot& slot = slots_[pos & mask_];
+        slot.value = value;
+        slot.seq.store(pos + 1, std::memory_order_release);
+        return pos + 1;
+    }
+
+    /*!
+     * @brief Извлечение самого старого элемента без ожидания (вызывается только потоком-читателем)
+     * @param[out] value Извлеченный элемент
+     * @return false, если буфер пуст или самый старый элемент еще записывается
+     */
+    bool tryPop(T& value) {
+        const size_t pos = tail_.value.load(std::memory_order_relaxed);
+        Slot& slot       = slots_[pos & mask_];
+        if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+            return false;
+        value = std::move(slot.value);
+        slot.seq.store(pos + capacity_, std::memory_order_release);
+        tail_.value.store(pos + 1, std::memory_order_release);
+        tail_.value.notify_all();
+        return true;
+    }
+
+    /// @brief Приблизительное количество элементов в буфере
+    size_t size() const {
+        const size_t tail = tail_.value.load(std::memory_order_acquire);
+        const size_t head = head_.value.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /// @brief Позиция записи: общее количество записанных и записываемых в буфер элементов
+    size_t written() const { return head_.value.load(std::memory_order_acquire); }
+
+    /// @brief Позиция чтения: общее количество извлеченных элементов
+    size_t consumed() const { return tail_.value.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(kCacheLine) Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    struct alignas(kCacheLine) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    /// @brief Позиция записи (захватывается писателями)
+    PaddedIndex head_;
+    /// @brief Позиция чтения (изменяется только читателем)
+    PaddedIndex tail_;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,287 @@
+/*!
+ * @file
+ * @brief Асинхронный вывод сообщений устройства: очередь записей и фоновый поток вывода
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "mpsc_ring.h"
+#include <atomic>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace output {
+
+/// @brief Вид записи
+enum class RecordType : uint8_t {
+    kText,          ///< Строка текста
+    kDisplayBegin,  ///< Начало вывода кадра на монитор, value - количество животных
+    kAnimal,        ///< Переведенное сообщение животного, animal - тип животного, value - номер животного (0 - нет)
+    kDisplayEnd,    ///< Конец вывода кадра на монитор
+};
+
+/// @brief Максимальная длина текста одной записи; более длинные строки обрезаются
+static constexpr size_t kTextCapacity = 232;
+
+/*!
+ * @brief Запись фиксированного размера, передаваемая потоку вывода
+ * Записи не владеют памятью, поэтому постановка в очередь не требует выделения памяти.
+ */
+struct Record {
+    /// @brief Время создания записи, нс от запуска монотонных часов
+    uint64_t timestamp;
+    uint32_t value;
+    uint16_t length;
+    RecordType type;
+    uint8_t animal;
+    char text[kTextCapacity];
+
+    std::string_view view() const { return std::string_view(text, length); }
+};
+
+/*!
+ * @brief Создание записи
+ * @param[in] type Вид записи
+ * @param[in] text Текст записи
+ * @param[in] value Числовое значение записи
+ * @param[in] animal Тип животного
+ */
+Record makeRecord(RecordType type, std::string_view text = {}, uint32_t value = 0, uint8_t animal = 0);
+
+/*!
+ * @brief Приемник записей
+ * Вызывается только потоком вывода: записи форматируются в общий буфер, а буфер целиком передается write().
+ */
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    /*!
+     * @brief Форматирование записи
+     * @param[in] record Запись
+     * @param[out] buffer Буфер, в конец которого дописывается представление записи
+     */
+    virtual void format(const Record& record, std::string& buffer) = 0;
+
+    /// @brief Запись отформатированного буфера
+    virtual void write(std::string_view buffer) = 0;
+
+    /// @brief Сброс буферов приемника после пачки записей
+    virtual void flush() {}
+};
+
+/// @brief Текстовый вывод на терминал или в файл
+class TextBackend : public Backend {
+public:
+    /*!
+     * @brief Создание текстового приемника
+     * @param[in] file Открытый файл
+     * @param[in] owned Закрыть файл при уничтожении приемника
+     */
+    TextBackend(FILE* file, bool owned) : file_(file), owned_(owned) {}
+
+    ~TextBackend() override;
+
+    void format(const Record& record, std::string& buffer) override;
+
+    void write(std::string_view buffer) override;
+
+    void flush() override;
+
+private:
+    FILE* file_;
+    bool owned_;
+};
+
+/*!
+ * @brief Двоичный вывод записей в файл
+ * Каждая запись хранится как ее заголовок (все поля Record до text) и length байт текста.
+ */
+class BinaryBackend : public Backend {
+public:
+    explicit BinaryBackend(FILE* file) : file_(file) {}
+
+    ~BinaryBackend() override;
+
+    void format(const Record& record, std::string& buffer) override;
+
+    void write(std::string_view buffer) override;
+
+    void flush() override;
+
+private:
+    FILE* file_;
+};
+
+/// @brief Вывод на терминал
+std::unique_ptr<Backend> terminal();
+
+/*!
+ * @brief Текстовый вывод в файл
+ * @param[in] path Путь к файлу; существующий файл перезаписывается
+ * @return Приемник или nullptr, если файл не удалось создать
+ */
+std::unique_ptr<Backend> textFile(const std::string& path);
+
+/*!
+ * @brief Двоичный вывод в файл
+ * @param[in] path Путь к файлу; существующий файл перезаписывается
+ * @return Приемник или nullptr, если файл не удалось создать
+ */
+std::unique_ptr<Backend> binaryFile(const std::string& path);
+
+/// @brief Счетчики вывода
+struct SinkStats {
+    size_t submitted;  ///< Записей поставлено в очередь
+    size_t written;    ///< Записей передано приемнику
+    size_t batches;    ///< Пачек записей (сбросов приемника)
+};
+
+/*!
+ * @brief Асинхронный вывод
+ * Любой поток ставит записи в очередь без блокировок и не ждет вывода. Фоновый поток вывода забирает все
+ * накопившиеся записи, форматирует их в заранее выделенный буфер и передает приемнику одной операцией записи,
+ * поэтому частые короткие сообщения не сбрасывают консоль по одному. В тихом режиме записи отбрасываются
+ * до форматирования.
+ */
+class Sink {
+public:
+    /*!
+     * @brief Создание вывода и запуск потока вывода
+     * @param[in] backend Приемник записей
+     * @param[in] capacity Емкость очереди записей, должна быть степенью двойки
+     */
+    explicit Sink(std::unique_ptr<Backend> backend, size_t capacity = kDefaultCapacity);
+
+    /// @brief Вывод оставшихся записей и остановка потока вывода
+    ~Sink();
+
+    Sink(const Sink&)            = delete;
+    Sink& operator=(const Sink&) = delete;
+
+    /// @brief Постановка записи в очередь (вызывается любым потоком)
+    void submit(const Record& record);
+
+    /// @brief Ожидание вывода всех записей, поставленных в очередь до вызова
+    void flush();
+
+    /*!
+     * @brief Замена приемника
+     * Записи, поставленные в очередь до замены, могут попасть в любой из приемников.
+     * @param[in] backend Новый приемник
+     */
+    void setBackend(std::unique_ptr<Backend> backend);
+
+    void setQuiet(bool value) { quiet_.store(value, std::memory_order_relaxed); }
+
+    bool quiet() const { return quiet_.load(std::memory_order_relaxed); }
+
+    SinkStats stats() const;
+
+    /// @brief Емкость очереди записей по умолчанию
+    static constexpr size_t kDefaultCapacity = 4096;
+    /// @brief Размер буфера форматирования, при заполнении которого буфер передается приемнику
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+private:
+    /// @brief Цикл потока вывода
+    void drain();
+
+    /// @brief Пробуждение потока вывода
+    void wake();
+
+    concurrency::MpscRing<Record> ring_;
+    /// @brief Буфер форматирования (используется только потоком вывода)
+    std::string buffer_;
+    std::mutex backend_mu_;
+    std::unique_ptr<Backend> backend_;
+    /// @brief Количество записей, переданных приемнику
+    std::atomic<size_t> written_{0};
+    std::atomic<size_t> batches_{0};
+    /// @brief Счетчик оповещений потока вывода о новых записях
+    std::atomic<unsigned> epoch_{0};
+    /// @brief Поток вывода спит и ждет оповещения; пока он работает, писатели его не будят
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> quiet_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread writer_;
+};
+
+/// @brief Общий вывод устройства (по умолчанию на терминал)
+Sink& sink();
+
+/*!
+ * @brief Строка текста, собираемая оператором << и поставляемая в очередь общего вывода при уничтожении
+ * Числа форматируются без выделения памяти так же, как в std::ostream по умолчанию.
+ */
+class Line {
+public:
+    /// @param[in] target Вывод, в который поставляется строка
+    explicit Line(Sink& target);
+
+    ~Line();
+
+    Line(const Line&)            = delete;
+    Line& operator=(const Line&) = delete;
+
+    Line& operator<<(std::string_view text);
+
+    Line& operator<<(const char* text) { return *this << std::string_view(text); }
+
+    Line& operator<<(const std::string& text) { return *this << std::string_view(text); }
+
+    Line& operator<<(char symbol) { return *this << std::string_view(&symbol, 1); }
+
+    template <std::integral T>
+    Line& operator<<(T value) {
+        if (active_)
+            append(std::to_chars(free(), end(), value));
+        return *this;
+    }
+
+    template <std::floating_point T>
+    Line& operator<<(T value) {
+        if (active_)
+            append(std::to_chars(free(), end(), value, std::chars_format::general, kPrecision));
+        return *this;
+    }
+
+private:
+    char* free() { return record_.text + record_.length; }
+
+    char* end() { return record_.text + kTextCapacity; }
+
+    /// @brief Учет символов, записанных std::to_chars; число, которому не хватило места, отбрасывается
+    void append(std::to_chars_result result) {
+        if (result.ec == std::errc())
+            record_.length = result.ptr - record_.text;
+    }
+
+    /// @brief Точность вывода дробных чисел, как у std::ostream по умолчанию
+    static constexpr int kPrecision = 6;
+
+    Sink& target_;
+    Record record_;
+    bool active_;
+};
+
+/// @brief Начало строки общего вывода: output::line() << "Текст " << value;
+inline Line line() { return Line(sink()); }
+
+/*!
+ * @brief Замер пропускной способности вывода
+ * Несколько потоков выводят одинаковые строки в /dev/null синхронно через std::ostream со сбросом каждой строки и
+ * асинхронно через Sink с текстовым и двоичным приемниками.
+ * @param[in] records Общее количество строк
+ */
+void runBenchmark(size_t records);
+
+}  // namespace output
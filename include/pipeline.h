@@ -0,0 +1,132 @@
+/*!
+ * @file
+ * @brief Потоковый режим работы переводчика: датчики, обработчики, переводчик и монитор работают одновременно
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include "blocking_queue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace translator {
+
+class Sensor;
+class Translator;
+class Monitor;
+
+/*!
+ * @brief Конвейер непрерывной обработки данных
+ * Каждая стадия работает в собственном потоке и связана со следующей ограниченной очередью, поэтому
+ * следующая порция данных считывается с датчиков, пока предыдущая переводится и выводится на экран.
+ */
+class StreamingPipeline {
+public:
+    /// @brief Стадии конвейера
+    enum Stage {
+        kSense = 0,  ///< Первичное чтение с датчиков
+        kFormat,     ///< Обработка видео и звука
+        kTranslate,  ///< Перевод
+        kDisplay,    ///< Вывод на экран
+        kMaxStage,
+    };
+
+    /// @brief Снимок состояния стадии
+    struct StageStats {
+        size_t processed;          ///< Количество обработанных порций данных
+        size_t queue_depth;        ///< Текущая заполненность выходной очереди стадии
+        size_t max_queue_depth;    ///< Максимальная заполненность выходной очереди стадии
+        double busy_seconds;       ///< Время полезной работы
+        double input_stall;        ///< Время простоя в ожидании входных данных
+        double output_stall;       ///< Время простоя в ожидании места в выходной очереди
+    };
+
+    /*!
+     * @brief Создание конвейера
+     * @param[in] sensor Обработчик входных сигналов
+     * @param[in] translator Переводчик
+     * @param[in] monitor Монитор
+     */
+    StreamingPipeline(Sensor& sensor, Translator& translator, Monitor& monitor);
+
+    ~StreamingPipeline() { stop(); }
+
+    /*!
+     * @brief Запуск всех стадий конвейера
+     */
+    void start();
+
+    /*!
+     * @brief Остановка конвейера
+     * Стадии дорабатывают уже считанные данные и завершаются.
+     */
+    void stop();
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    /*!
+     * @brief Состояние стадий конвейера
+     * @return Статистика по каждой стадии в порядке их следования
+     */
+    std::array<StageStats, kMaxStage> stats() const;
+
+    /// @brief Названия стадий для вывода статистики
+    static constexpr std::array<const char*, kMaxStage> kStageNames = {"датчики", "обработка", "перевод", "монитор"};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct StageCounters {
+        std::atomic<size_t> processed{0};
+        std::atomic<size_t> max_queue_depth{0};
+        std::atomic<long> busy_ns{0};
+        std::atomic<long> input_stall_ns{0};
+        std::atomic<long> output_stall_ns{0};
+    };
+
+    void senseStage();
+
+    void formatStage();
+
+    void translateStage();
+
+    void displayStage();
+
+    /// @brief Передача результата стадии в выходную очередь с учетом времени простоя
+    template <typename T>
+    bool forward(Stage stage, concurrency::BlockingQueue<T>& queue, T value);
+
+    /// @brief Получение данных из входной очереди стадии с учетом времени простоя
+    template <typename T>
+    bool receive(Stage stage, concurrency::BlockingQueue<T>& queue, T& value);
+
+    void account(std::atomic<long>& counter, Clock::time_point since);
+
+    Sensor& sensor_;
+    Translator& translator_;
+    Monitor& monitor_;
+
+    concurrency::BlockingQueue<animal::PackedData> sensed_;
+    concurrency::BlockingQueue<animal::PreparedData> formatted_;
+    concurrency::BlockingQueue<std::vector<animal::DecodedAnimalCharacteristic>> translated_;
+    /// @brief Выведенные монитором массивы сообщений, возвращаемые переводчику для следующих кадров
+    concurrency::BlockingQueue<std::vector<animal::DecodedAnimalCharacteristic>> recycled_;
+
+    std::array<StageCounters, kMaxStage> counters_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+
+    /// @brief Емкость очередей между стадиями
+    static constexpr size_t kStageQueueCapacity = 4;
+    /// @brief Максимальное количество накопившихся кадров, переводимых за один вызов
+    static constexpr size_t kMaxTranslateBatch = 8;
+    /// @brief Период проверки признака остановки при ожидании данных с датчиков
+    static constexpr std::chrono::milliseconds kSensePollTimeout{200};
+};
+
+}  // namespace translator
@@ -0,0 +1,96 @@
+/*!
+ * @file
+ * @brief Быстрый генератор псевдослучайных чисел с собственным состоянием для каждого потока
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace prng {
+
+/*!
+ * @brief Генератор xoshiro256**
+ * Период 2^256 - 1, состояние из четырех 64-битных слов, несколько тактов на число. В отличие от std::rand
+ * не имеет скрытого общего состояния, поэтому каждый поток работает со своим генератором без синхронизации.
+ * Удовлетворяет требованиям UniformRandomBitGenerator.
+ */
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0) { this->seed(seed); }
+
+    /*!
+     * @brief Установка начального состояния
+     * Состояние разворачивается из зерна генератором splitmix64, поэтому близкие зерна дают независимые
+     * последовательности.
+     * @param[in] seed Зерно
+     */
+    void seed(uint64_t seed) {
+        for (auto& word : state_) {
+            seed += 0x9e3779b97f4a7c15;
+            uint64_t mixed = seed;
+            mixed          = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9;
+            mixed          = (mixed ^ (mixed >> 27)) * 0x94d049bb133111eb;
+            word           = mixed ^ (mixed >> 31);
+        }
+    }
+
+    uint64_t operator()() {
+        const uint64_t result  = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t shifted = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= shifted;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    /// @brief Равномерно распределенное целое число из [0, bound)
+    uint64_t below(uint64_t bound) {
+        // Умножение с отбрасыванием младшей половины вместо деления по модулю (метод Лемира)
+        return (uint64_t)(((unsigned __int128)(*this)() * bound) >> 64);
+    }
+
+    /// @brief Равномерно распределенное целое число из [low, high)
+    long between(long low, long high) { return low + (long)below(high - low); }
+
+    /// @brief Равномерно распределенное число из [0, 1)
+    double real() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+    /// @brief Равномерно распределенное число из [low, high)
+    double uniform(double low, double high) { return low + real() * (high - low); }
+
+    static constexpr uint64_t min() { return 0; }
+
+    static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); }
+
+private:
+    static uint64_t rotl(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+
+    uint64_t state_[4];
+};
+
+/*!
+ * @brief Генератор текущего потока
+ * Пока поток не задал зерно через seed(), генератор инициализируется временем запуска и порядковым номером потока.
+ */
+inline Xoshiro256& local() {
+    static std::atomic<uint64_t> thread_counter{0};
+    thread_local Xoshiro256 generator(
+        (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^
+        (thread_counter.fetch_add(1, std::memory_order_relaxed) << 48));
+    return generator;
+}
+
+/// @brief Задание зерна генератора текущего потока для воспроизводимой последовательности
+inline void seed(uint64_t value) { local().seed(value); }
+
+}  // namespace prng
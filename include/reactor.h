@@ -7,11 +7,16 @@
 #pragma once
 
 #include "animal_types.h"
+#include "output.h"
+#include "readiness_event.h"
+#include "session.h"
 #include "condition_variable"
 #include "mutex"
+#include <array>
+#include <chrono>
 #include <cmath>
-#include <deque>
-#include <iostream>
+#include <string>
+#include <string_view>
 
 namespace reactor {
 
@@ -23,18 +28,15 @@ class AnimalReactor {
 public:
     /*!
      * @brief Создание генератора данных
-     * @param[out] pantomime Поток генерируемого видео
-     * @param[out] sound Поток генерируемого звука
-     * @param[out] types Поток генерируемых типов животных
-     * @param[out] reactive_cv Триггер на генерируемые данные.
+     * @param[out] frames Поток генерируемых кадров (видео, звук и типы животных)
+     * @param[out] audio Поток отсчетов микрофона, в который записывается звук бесед
+     * @param[out] reactive_cv Событие готовности, взводимое после публикации кадра.
      */
-    AnimalReactor(std::deque<pantomime::Video>& pantomime, std::deque<syllable::Noise>& sound,
-                  std::deque<animal::AnimalDecodingStub>& types, bool& reactive_cv);
+    AnimalReactor(animal::FrameRing& frames, animal::AudioRing& audio, concurrency::ReadinessEvent& reactive_cv);
 
     ~AnimalReactor() {
-        std::cout << "Зоопарк закрывается..." << std::endl;
-        is_talking  = false;
-        reactive_cv = false;
+        output::line() << "Зоопарк закрывается...";
+        is_talking = false;
     }
 
     /*!
@@ -44,17 +46,34 @@ public:
      */
     void startTalking();
 
+    /*!
+     * @brief Начало записи сеанса
+     * Все последующие беседы (видео, звук и виды животных) записываются в файл до вызова stopRecording().
+     * @param[in] path Путь к файлу сеанса
+     * @return false, если файл не удалось создать
+     */
+    bool startRecording(const std::string& path);
+
+    /// @brief Окончание записи сеанса
+    void stopRecording();
+
     /// @brief Переменная опроса. Имитирует состояние окружения - есть ли рядом животные.
     volatile bool is_talking;
 
 private:
     std::mutex mu_;
     std::condition_variable cv_;
-    std::deque<syllable::Noise>& sound;
-    bool& reactive_cv;
-    std::deque<pantomime::Video>& pantomime;
-    std::deque<animal::AnimalDecodingStub>& types;
-    std::map<animal::AnimalType, std::string> animal_names;
+    animal::FrameRing& frames;
+    animal::AudioRing& audio;
+    concurrency::ReadinessEvent& reactive_cv;
+    /// @brief Буфер фрагмента звука, записываемого в поток микрофона
+    std::array<float, 1024> audio_chunk;
+    /// @brief Запись сеанса
+    session::SessionWriter recorder;
+    /// @brief Время начала записи сеанса
+    std::chrono::steady_clock::time_point record_start;
+    static constexpr animal::AnimalTable<std::string_view> animal_names =
+        animal::makeAnimalTable<std::string_view>("Кот", "Пёс", "Попугай", "Корова", "Овца");
 
     static constexpr double kMaxSecond     = 2;     ///< Максимальное значение диапазона задержки
     static constexpr double kMinSecond     = 1;     ///< Минимальное значение диапазона задержки
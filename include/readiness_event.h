@@ -0,0 +1,69 @@
+/*!
+ * @file
+ * @brief Примитив готовности данных для передачи сигнала от окружения к датчикам устройства
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace concurrency {
+
+/*!
+ * @brief Событие готовности с автоматическим сбросом
+ * Писатель взводит событие после публикации данных, читатель блокируется на нем с таймаутом.
+ * Дополнительно событие доступно как файловый дескриптор (eventfd), что позволяет одному циклу событий
+ * (poll/epoll) обслуживать сразу много датчиков.
+ */
+class ReadinessEvent {
+public:
+    ReadinessEvent();
+
+    ~ReadinessEvent();
+
+    ReadinessEvent(const ReadinessEvent&)            = delete;
+    ReadinessEvent& operator=(const ReadinessEvent&) = delete;
+
+    /*!
+     * @brief Взведение события и пробуждение ожидающих
+     */
+    void notify();
+
+    /*!
+     * @brief Ожидание события не дольше указанного времени
+     * @param[in] timeout Максимальное время ожидания
+     * @return true, если событие было взведено (при этом оно сбрасывается)
+     */
+    bool waitFor(std::chrono::milliseconds timeout) { return waitUntil(std::chrono::steady_clock::now() + timeout); }
+
+    /*!
+     * @brief Ожидание события до указанного момента времени
+     * @param[in] deadline Момент, после которого ожидание прекращается
+     * @return true, если событие было взведено (при этом оно сбрасывается)
+     */
+    bool waitUntil(std::chrono::steady_clock::time_point deadline);
+
+    /*!
+     * @brief Сброс события после того, как его готовность была получена через файловый дескриптор
+     */
+    void consume();
+
+    /*!
+     * @brief Файловый дескриптор для poll/epoll
+     * @return Дескриптор, становящийся читаемым при взведении события, или -1, если платформа его не поддерживает
+     */
+    int fd() const { return fd_; }
+
+private:
+    void drainFd();
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool signaled_ = false;
+    int fd_        = -1;
+};
+
+}  // namespace concurrency
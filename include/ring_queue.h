@@ -0,0 +1,76 @@
+/*!
+ * @file
+ * @brief Двусторонняя очередь в кольцевом буфере, выделяющая память только при росте
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+/*!
+ * @brief Двусторонняя очередь в кольцевом буфере (без синхронизации)
+ * В отличие от std::deque, который выделяет и освобождает блоки по мере сдвига элементов, буфер растет вдвое только
+ * при заполнении, поэтому очередь, через которую проходит ограниченное количество элементов, после разогрева
+ * не выделяет память. Извлеченные элементы остаются в ячейках в состоянии после перемещения.
+ */
+template <typename T>
+class RingQueue {
+public:
+    /// @brief Начальная емкость по умолчанию
+    static constexpr size_t kInitialCapacity = 16;
+
+    /*!
+     * @brief Создание очереди
+     * @param[in] capacity Начальная емкость
+     */
+    explicit RingQueue(size_t capacity = kInitialCapacity) : slots_(std::max<size_t>(capacity, 1)) {}
+
+    bool empty() const { return count_ == 0; }
+
+    size_t size() const { return count_; }
+
+    /// @brief Добавление элемента в конец очереди
+    void pushBack(T value) {
+        if (count_ == slots_.size())
+            grow();
+        slots_[(head_ + count_) % slots_.size()] = std::move(value);
+        count_++;
+    }
+
+    /// @brief Извлечение элемента из начала непустой очереди
+    T popFront() {
+        T value = std::move(slots_[head_]);
+        head_   = (head_ + 1) % slots_.size();
+        count_--;
+        return value;
+    }
+
+    /// @brief Извлечение элемента из конца непустой очереди
+    T popBack() {
+        count_--;
+        return std::move(slots_[(head_ + count_) % slots_.size()]);
+    }
+
+private:
+    /// @brief Перенос элементов в буфер вдвое большего размера, начиная с первого
+    void grow() {
+        std::vector<T> grown(slots_.size() * 2);
+        for (size_t iter = 0; iter < count_; iter++) grown[iter] = std::move(slots_[(head_ + iter) % slots_.size()]);
+        slots_ = std::move(grown);
+        head_  = 0;
+    }
+
+    std::vector<T> slots_;
+    /// @brief Позиция первого элемента в буфере
+    size_t head_ = 0;
+    /// @brief Количество элементов в очереди
+    size_t count_ = 0;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,169 @@
+/*!
+ * @file
+ * @brief Кольцевой буфер отсчетов непрерывного сигнала с чтением без копирования
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "spsc_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+namespace concurrency {
+
+/*!
+ * @brief Кольцевой буфер отсчетов для одного писателя и одного читателя
+ * В отличие от SpscRing элементами являются отдельные отсчеты, а читатель получает доступ к непрерывному участку
+ * сигнала прямо в памяти буфера (двумя частями, если участок пересекает конец буфера) и сам решает, сколько отсчетов
+ * освободить. Это позволяет анализировать перекрывающиеся кадры без копирования. Позиции записи и чтения
+ * отсчитываются от начала потока и не сбрасываются при переходе через конец буфера.
+ */
+template <typename T>
+class SampleRing {
+public:
+    /// @brief Непрерывный участок сигнала: начало и продолжение после перехода через конец буфера
+    struct Regions {
+        std::span<const T> head;
+        std::span<const T> tail;
+
+        size_t size() const { return head.size() + tail.size(); }
+    };
+
+    /*!
+     * @brief Создание буфера
+     * @param[in] capacity Емкость буфера в отсчетах, должна быть степенью двойки
+     */
+    explicit SampleRing(size_t capacity)
+        : capacity_(capacity),
+          mask_(capacity - 1),
+          samples_(std::make_unique<T[]>(capacity)) {
+        if (capacity == 0 || (capacity & mask_) != 0)
+            throw std::invalid_argument("SampleRing capacity must be a power of two");
+    }
+
+    SampleRing(const SampleRing&)            = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    /*!
+     * @brief Запись отсчетов (вызывается только потоком-писателем)
+     * Писатель спит, пока в буфере нет места для всех отсчетов.
+     * @param[in] samples Записываемые отсчеты
+     * @return false, если буфер закрыт и отсчеты записаны не полностью
+     */
+    bool write(std::span<const T> samples) {
+        while (!samples.empty()) {
+            const size_t head = head_.value.load(std::memory_order_relaxed);
+            const size_t free = capacity_ - (head - tail_.value.load(std::memory_order_acquire));
+            if (free == 0) {
+                if (!waitFor([&] { return head - tail_.value.load(std::memory_order_acquire) < capacity_; }))
+                    return false;
+                continue;
+            }
+            const size_t count = std::min(free, samples.size());
+            const size_t first = std::min(count, capacity_ - (head & mask_));
+            std::copy_n(samples.begin(), first, samples_.get() + (head & mask_));
+            std::copy_n(samples.begin() + first, count - first, samples_.get());
+            head_.value.store(head + count, std::memory_order_release);
+            signal();
+            samples = samples.subspan(count);
+        }
+        return true;
+    }
+
+    /*!
+     * @brief Доступ к непрочитанным отсчетам без копирования (вызывается только потоком-читателем)
+     * Отсчеты остаются в буфере до вызова consume().
+     * @param[in] count Максимальное количество отсчетов
+     * @return Участок из не более count отсчетов, начиная с позиции чтения
+     */
+    Regions peek(size_t count) const {
+        const size_t tail  = tail_.value.load(std::memory_order_relaxed);
+        const size_t size  = std::min(count, head_.value.load(std::memory_order_acquire) - tail);
+        const size_t first = std::min(size, capacity_ - (tail & mask_));
+        return (Regions){.head = std::span<const T>(samples_.get() + (tail & mask_), first),
+                         .tail = std::span<const T>(samples_.get(), size - first)};
+    }
+
+    /*!
+     * @brief Освобождение прочитанных отсчетов (вызывается только потоком-читателем)
+     * @param[in] count Количество отсчетов, не больше size()
+     */
+    void consume(size_t count) {
+        tail_.value.store(tail_.value.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        signal();
+    }
+
+    /*!
+     * @brief Ожидание поступления отсчетов (вызывается только потоком-читателем)
+     * @param[in] count Необходимое количество непрочитанных отсчетов, не больше capacity()
+     * @return false, если буфер закрыт раньше, чем поступили отсчеты
+     */
+    bool waitForData(size_t count) {
+        return size() >= count || waitFor([&] { return size() >= count; });
+    }
+
+    /*!
+     * @brief Закрытие буфера
+     * Ожидающие писатель и читатель просыпаются, дальнейшие ожидания завершаются сразу.
+     */
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        signal();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    /// @brief Количество непрочитанных отсчетов
+    size_t size() const {
+        return head_.value.load(std::memory_order_acquire) - tail_.value.load(std::memory_order_acquire);
+    }
+
+    /// @brief Позиция записи: общее количество записанных в поток отсчетов
+    size_t written() const { return head_.value.load(std::memory_order_acquire); }
+
+    /// @brief Позиция чтения: общее количество освобожденных читателем отсчетов
+    size_t consumed() const { return tail_.value.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(kCacheLine) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+
+    /// @brief Оповещение ожидающей стороны об изменении позиций или закрытии
+    void signal() {
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+    }
+
+    /// @brief Ожидание выполнения условия; изменения позиций отслеживаются по счетчику оповещений
+    template <typename Predicate>
+    bool waitFor(Predicate ready) {
+        while (true) {
+            const unsigned epoch = epoch_.load(std::memory_order_acquire);
+            if (ready())
+                return true;
+            if (closed())
+                return false;
+            epoch_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> samples_;
+    /// @brief Позиция записи (изменяется только писателем)
+    PaddedIndex head_;
+    /// @brief Позиция чтения (изменяется только читателем)
+    PaddedIndex tail_;
+    std::atomic<unsigned> epoch_{0};
+    std::atomic<bool> closed_{false};
+};
+
+}  // namespace concurrency
@@ -0,0 +1,179 @@
+/*!
+ * @file
+ * @brief Формат записанного сеанса: запись кадров на диск и чтение через отображение файла в память
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace session {
+
+/*!
+ * @brief Заголовок файла сеанса
+ * Файл состоит из заголовка, записей кадров и индекса - массива смещений записей от начала файла. Все данные
+ * хранятся в порядке байтов и с выравниванием платформы, на которой сеанс записан, поэтому читаются без разбора.
+ */
+struct FileHeader {
+    char magic[8];            ///< Сигнатура kMagic
+    uint32_t version;         ///< Версия формата kVersion
+    uint32_t header_size;     ///< Размер заголовка файла
+    uint64_t frame_count;     ///< Количество кадров
+    uint64_t index_offset;    ///< Смещение индекса от начала файла
+    uint32_t pantomime_size;  ///< Размер pantomime::Pantomime при записи
+    uint32_t sound_size;      ///< Размер syllable::Sound при записи
+    uint8_t reserved[24];
+};
+
+/// @brief Заголовок записи кадра. За ним следуют фигуры, звуки, виды животных, карта диспаритета и звук
+struct FrameHeader {
+    double timestamp;        ///< Время кадра от начала записи, с
+    double distance;         ///< Показания дальномера, м
+    uint32_t figure_count;   ///< Количество фигур
+    uint32_t sound_count;    ///< Количество звуков
+    uint32_t type_count;     ///< Количество видов животных
+    uint32_t sample_rate;    ///< Частота дискретизации звука, Гц
+    uint32_t width;          ///< Ширина карты диспаритета
+    uint32_t height;         ///< Высота карты диспаритета
+    uint64_t sample_count;   ///< Количество отсчетов звука
+};
+
+inline constexpr char kMagic[8]   = {'A', 'T', 'S', 'E', 'S', 'S', 'N', '\0'};
+inline constexpr uint32_t kVersion = 1;
+/// @brief Выравнивание секций записи кадра
+inline constexpr size_t kAlignment = 8;
+
+static_assert(sizeof(FileHeader) == 64);
+static_assert(std::is_trivially_copyable_v<pantomime::Pantomime> && std::is_trivially_copyable_v<syllable::Sound>);
+static_assert(alignof(pantomime::Pantomime) <= kAlignment && alignof(syllable::Sound) <= kAlignment);
+
+/// @brief Кадр записанного сеанса без владения данными: все поля указывают в отображенный в память файл
+struct FrameView {
+    double timestamp;
+    double distance;
+    pantomime::VideoView video;
+    syllable::NoiseView noise;
+    std::span<const animal::AnimalType> types;
+};
+
+/*!
+ * @brief Запись сеанса
+ * Кадр записывается в три шага: заголовок и данные кадра, звук (фрагментами по мере его поступления) и
+ * завершение кадра. Индекс и итоговый заголовок файла записываются при закрытии.
+ */
+class SessionWriter {
+public:
+    SessionWriter() = default;
+
+    SessionWriter(const SessionWriter&)            = delete;
+    SessionWriter& operator=(const SessionWriter&) = delete;
+
+    ~SessionWriter() { close(); }
+
+    /*!
+     * @brief Создание файла сеанса
+     * @param[in] path Путь к файлу; существующий файл перезаписывается
+     * @return false, если файл не удалось создать
+     */
+    bool open(const std::string& path);
+
+    /*!
+     * @brief Начало записи кадра
+     * @param[in] frame Кадр; звук кадра записывается следом через writeSamples()
+     * @param[in] timestamp Время кадра от начала записи, с
+     */
+    bool beginFrame(const animal::Frame& frame, double timestamp);
+
+    /// @brief Запись очередного фрагмента звука текущего кадра
+    bool writeSamples(std::span<const float> samples);
+
+    /// @brief Завершение записи кадра
+    bool endFrame();
+
+    /// @brief Запись индекса и закрытие файла
+    bool close();
+
+    bool isOpen() const { return file_.is_open(); }
+
+    size_t frameCount() const { return index_.size(); }
+
+private:
+    /// @brief Дополнение текущей секции нулями до kAlignment
+    void pad();
+
+    template <typename T>
+    void writeArray(std::span<const T> values) {
+        file_.write(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+        offset_ += values.size_bytes();
+        pad();
+    }
+
+    std::ofstream file_;
+    std::vector<uint64_t> index_;
+    /// @brief Копии фигур и звуков кадра с обнуленными байтами выравнивания структур
+    std::vector<pantomime::Pantomime> figures_;
+    std::vector<syllable::Sound> sounds_;
+    /// @brief Смещение конца записанных данных от начала файла
+    uint64_t offset_ = 0;
+    /// @brief Количество отсчетов звука, которое еще должно быть записано в текущий кадр
+    uint64_t pending_samples_ = 0;
+    bool in_frame_            = false;
+};
+
+/*!
+ * @brief Чтение сеанса
+ * Файл отображается в память целиком, при открытии проверяются заголовок, границы всех записей и значения
+ * признаков в них: файл с недопустимым значением не открывается. Кадры выдаются
+ * в виде FrameView без копирования и выделения памяти; операционная система подгружает страницы файла по мере
+ * чтения, поэтому сеанс любого размера воспроизводится со скоростью диска.
+ */
+class SessionReader {
+public:
+    SessionReader() = default;
+
+    SessionReader(const SessionReader&)            = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    ~SessionReader() { close(); }
+
+    /*!
+     * @brief Открытие файла сеанса
+     * @param[in] path Путь к файлу
+     * @return false, если файл не удалось открыть или он поврежден
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    size_t size() const { return frames_.size(); }
+
+    /// @brief Размер файла, байты
+    size_t bytes() const { return size_; }
+
+    /*!
+     * @brief Доступ к кадру
+     * @param[in] index Номер кадра, меньше size()
+     * @return Кадр; данные действительны до закрытия файла
+     */
+    const FrameView& frame(size_t index) const { return frames_[index]; }
+
+private:
+    /// @brief Разбор записи кадра с проверкой границ секций и допустимости значений
+    bool parseFrame(uint64_t offset, FrameView& frame) const;
+
+    /// @brief Проверка значений кадра: перечисления из файла используются как индексы таблиц и величины сдвигов
+    static bool validFrame(const FrameView& frame);
+
+    const uint8_t* data_ = nullptr;
+    size_t size_         = 0;
+    std::vector<FrameView> frames_;
+};
+
+}  // namespace session
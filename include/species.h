@@ -0,0 +1,83 @@
+/*!
+ * @file
+ * @brief Признаки видов животных как константы времени компиляции и выбор специализированного кода по виду
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace animal {
+
+/// @brief Вид животного как тип: параметр обобщенных обработчиков, специализированных по виду
+template <AnimalType Type>
+using Species = std::integral_constant<AnimalType, Type>;
+
+/// @brief Битовая маска множества значений признака
+template <typename T, size_t N>
+constexpr uint32_t traitMask(const TraitSet<T, N>& values) {
+    uint32_t mask = 0;
+    for (T value : values) mask |= 1u << value;
+    return mask;
+}
+
+/*!
+ * @brief Признаки вида
+ * Значения берутся из таблиц признаков (animal_sizes, animal_frequency, ...) во время компиляции, поэтому код,
+ * специализированный по виду, сравнивает признаки животного с непосредственными константами.
+ */
+template <AnimalType Type>
+struct SpeciesTraits {
+    static constexpr long kSizeMin        = animal_sizes[Type].first;
+    static constexpr long kSizeMax        = animal_sizes[Type].second;
+    static constexpr int kVolumeMin       = animal_volume[Type].first;
+    static constexpr int kVolumeMax       = animal_volume[Type].second;
+    static constexpr double kFrequencyMax = animal_frequency[Type];
+    static constexpr auto kLarynx         = animal_larynx[Type];
+    static constexpr auto kThroat         = animal_throat[Type];
+    /// @brief Битовые маски звуков гортани и горла
+    static constexpr uint32_t kLarynxMask = traitMask(kLarynx);
+    static constexpr uint32_t kThroatMask = traitMask(kThroat);
+};
+
+/*!
+ * @brief Вызов обработчика, специализированного по виду
+ * Вид проверяется один раз, дальше выполняется код, в котором вид - константа времени компиляции.
+ * @param[in] type Вид животного
+ * @param[in] function Обобщенный обработчик function(Species<Type>)
+ */
+template <typename Function>
+decltype(auto) dispatchSpecies(AnimalType type, Function&& function) {
+    static_assert(MaxAnimalType == 5, "новый вид нужно добавить в dispatchSpecies");
+    switch (type) {
+        case Dog:
+            return function(Species<Dog>{});
+        case Parrot:
+            return function(Species<Parrot>{});
+        case Cow:
+            return function(Species<Cow>{});
+        case Sheep:
+            return function(Species<Sheep>{});
+        default:
+            return function(Species<Cat>{});
+    }
+}
+
+/*!
+ * @brief Вызов обработчика для каждого вида по порядку перечисления AnimalType
+ * Цикл по видам разворачивается во время компиляции.
+ * @param[in] function Обобщенный обработчик function(Species<Type>)
+ */
+template <typename Function>
+void forEachSpecies(Function&& function) {
+    [&function]<size_t... Types>(std::index_sequence<Types...>) {
+        (function(Species<static_cast<AnimalType>(Types)>{}), ...);
+    }(std::make_index_sequence<MaxAnimalType>{});
+}
+
+}  // namespace animal
@@ -0,0 +1,259 @@
+/*!
+ * @file
+ * @brief Спектральный анализ звука: БПФ, поиск пиков и выделение несущих
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include "execution.h"
+#include "task_pool.h"
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace spectrum {
+
+/*!
+ * @brief План быстрого преобразования Фурье (радикс-2)
+ * Таблицы поворачивающих множителей и перестановки индексов вычисляются один раз при создании плана,
+ * после чего план многократно применяется к блокам одного размера. Для векторного преобразования множители
+ * каждого этапа дополнительно хранятся подряд, чтобы бабочки этапа читали их непрерывно.
+ */
+class FftPlan {
+public:
+    /*!
+     * @brief Создание плана
+     * @param[in] size Размер преобразования, степень двойки
+     */
+    explicit FftPlan(size_t size);
+
+    size_t size() const { return size_; }
+
+    /*!
+     * @brief Прямое преобразование на месте
+     * @param[in,out] data Блок из size() комплексных отсчетов
+     * @param[in] vectorized Бабочки выполняются инструкциями AVX2 по четыре (если процессор их поддерживает)
+     */
+    void forward(std::span<std::complex<float>> data, bool vectorized = false) const;
+
+private:
+    size_t size_;
+    std::vector<uint32_t> bit_reverse_;
+    std::vector<std::complex<float>> twiddles_;
+    /// @brief Множители этапов с половиной длины блока half >= 4, множители этапа начинаются с half - 4
+    std::vector<std::complex<float>> stage_twiddles_;
+};
+
+/// @brief Спектральный пик одного кадра анализа
+struct Peak {
+    float frequency;  ///< Частота пика, Гц (уточнена параболической интерполяцией)
+    float level;      ///< Уровень пика в единицах громкости syllable::Sound::volume
+};
+
+/*!
+ * @brief Отслеживание несущих между кадрами анализа
+ * Пики соседних кадров с близкой частотой объединяются в одну несущую. Несущая считается завершенной,
+ * если в течение max_gap кадров для нее не нашлось продолжения.
+ */
+class CarrierTracker {
+public:
+    /*!
+     * @brief Сброс состояния перед анализом нового звука
+     * @param[in] frame_seconds Шаг между кадрами анализа, с
+     * @param[in] tolerance Допустимое отклонение частоты пика от частоты несущей, Гц
+     * @param[in] max_gap Количество кадров без продолжения, после которого несущая завершается
+     */
+    void reset(double frame_seconds, float tolerance, size_t max_gap);
+
+    /*!
+     * @brief Учет пиков очередного кадра
+     * @param[in] peaks Пики кадра
+     * @param[in] frame Номер кадра
+     * @param[out] finished Завершенные несущие (дописываются в конец)
+     */
+    void update(std::span<const Peak> peaks, size_t frame, std::vector<syllable::Sound>& finished);
+
+    /*!
+     * @brief Завершение всех несущих
+     * @param[out] finished Завершенные несущие (дописываются в конец)
+     */
+    void flush(std::vector<syllable::Sound>& finished);
+
+    size_t active() const { return tracks_.size(); }
+
+private:
+    struct Track {
+        double frequency_sum;
+        float level;
+        float last_frequency;
+        size_t first_frame;
+        size_t last_frame;
+        size_t frames;
+    };
+
+    syllable::Sound finish(const Track& track) const;
+
+    std::vector<Track> tracks_;
+    double frame_seconds_ = 0;
+    float tolerance_      = 0;
+    size_t max_gap_       = 0;
+};
+
+/*!
+ * @brief Спектральный анализатор звука
+ * Звук разбивается на перекрывающиеся кадры, каждый кадр умножается на окно Блэкмана-Харриса и переводится
+ * в частотную область. В спектре выделяются пики, которые объединяются в несущие с частотой, громкостью и
+ * длительностью.
+ */
+class SpectralAnalyzer {
+public:
+    /*!
+     * @brief Создание анализатора
+     * @param[in] frame_size Размер кадра анализа, степень двойки
+     * @param[in] hop Шаг между кадрами анализа
+     */
+    explicit SpectralAnalyzer(size_t frame_size = kDefaultFrameSize, size_t hop = kDefaultHop);
+
+    /*!
+     * @brief Поиск пиков в одном кадре
+     * Кадр может быть передан двумя частями (например, при чтении из кольцевого буфера). Если суммарная длина частей
+     * меньше размера кадра, кадр дополняется нулями.
+     * @param[in] head Начало кадра
+     * @param[in] tail Продолжение кадра
+     * @param[in] sample_rate Частота дискретизации, Гц
+     * @return Пики кадра; данные действительны до следующего вызова
+     */
+    std::span<const Peak> findPeaks(std::span<const float> head, std::span<const float> tail, unsigned sample_rate);
+
+    /// @brief Разрешение по частоте, Гц
+    double resolution(unsigned sample_rate) const { return (double)sample_rate / plan_.size(); }
+
+    /// @brief Наложение окна, преобразование и мощность спектра выполняются инструкциями AVX2
+    void setVectorized(bool value) { vectorized_ = value && execution::hasAvx2(); }
+
+    size_t frameSize() const { return plan_.size(); }
+
+    size_t hop() const { return hop_; }
+
+    static constexpr size_t kDefaultFrameSize = 4096;
+    static constexpr size_t kDefaultHop       = 2048;
+    /// @brief Динамический диапазон поиска пиков относительно самого громкого пика кадра
+    static constexpr float kDynamicRange = 90;
+    /// @brief Минимальная громкость пика
+    static constexpr float kMinLevel = 10;
+    /// @brief Полуширина окрестности, в которой пик должен быть максимумом (главный лепесток окна)
+    static constexpr size_t kPeakRadius = 4;
+    /// @brief Допустимое отклонение частоты несущей между кадрами, в отсчетах спектра
+    static constexpr float kTrackBins = 2;
+    /// @brief Количество кадров без продолжения, после которого несущая завершается
+    static constexpr size_t kTrackGap = 1;
+
+private:
+    /*!
+     * @brief Поиск пиков в уровнях спектра кадра
+     * @param[in] max_level Уровень самого громкого отсчета спектра
+     * @param[in] sample_rate Частота дискретизации, Гц
+     */
+    std::span<const Peak> collectPeaks(float max_level, unsigned sample_rate);
+
+    FftPlan plan_;
+    size_t hop_;
+    std::vector<float> window_;
+    float window_sum_;
+    std::vector<std::complex<float>> buffer_;
+    std::vector<float> level_;
+    std::vector<Peak> peaks_;
+    bool vectorized_ = false;
+};
+
+/*!
+ * @brief Потоковый спектральный анализатор
+ * Звук читается из кольцевого буфера кадрами по мере поступления: кадр анализируется прямо в памяти буфера,
+ * после чего освобождается только шаг между кадрами, а перекрытие остается для следующего кадра. Несущая
+ * выдается сразу, как только она завершилась, поэтому память и задержка анализа не зависят от длины беседы.
+ * В многопоточной реализации все поступившие кадры делятся на части, каждая часть анализируется в пуле потоков
+ * своим анализатором, а пики кадров передаются отслеживанию несущих в исходном порядке.
+ */
+class StreamingAnalyzer {
+public:
+    /*!
+     * @brief Создание анализатора
+     * @param[in] frame_size Размер кадра анализа, степень двойки
+     * @param[in] hop Шаг между кадрами анализа
+     */
+    explicit StreamingAnalyzer(size_t frame_size = SpectralAnalyzer::kDefaultFrameSize,
+                               size_t hop        = SpectralAnalyzer::kDefaultHop);
+
+    /*!
+     * @brief Начало анализа очередной беседы
+     * @param[in] sample_rate Частота дискретизации, Гц
+     * @param[in] length Длина беседы в отсчетах
+     * @param[in] backend Реализация анализа беседы
+     * @param[in] pool Пул потоков для многопоточной реализации (nullptr - многопоточная реализация недоступна)
+     */
+    void begin(unsigned sample_rate, size_t length, execution::Backend backend = execution::kScalar,
+               concurrency::TaskPool* pool = nullptr);
+
+    /*!
+     * @brief Анализ всех полностью поступивших кадров беседы
+     * @param[in,out] ring Поток отсчетов; проанализированные отсчеты освобождаются
+     * @param[out] finished Завершенные несущие (дописываются в конец)
+     * @return true, если беседа проанализирована целиком
+     */
+    bool feed(animal::AudioRing& ring, std::vector<syllable::Sound>& finished);
+
+    /*!
+     * @brief Анализ беседы, звук которой уже записан целиком
+     * Кадры анализируются прямо в памяти записи, без копирования.
+     * @param[in] samples Отсчеты беседы, начиная с первого еще не проанализированного
+     * @param[out] finished Завершенные несущие (дописываются в конец)
+     * @return true, если беседа проанализирована целиком
+     */
+    bool feed(std::span<const float> samples, std::vector<syllable::Sound>& finished);
+
+    /// @brief Количество отсчетов, которое должно поступить для анализа следующего кадра
+    size_t pending() const { return std::min(analyzer_.frameSize(), remaining_); }
+
+    /// @brief Допустимое отклонение частоты несущей между кадрами, Гц
+    float tolerance() const { return SpectralAnalyzer::kTrackBins * analyzer_.resolution(sample_rate_); }
+
+private:
+    /// @brief Кадр анализа, ожидающий многопоточной обработки
+    struct PendingFrame {
+        std::span<const float> head;
+        std::span<const float> tail;
+        size_t step;  ///< Количество отсчетов, освобождаемых после кадра
+    };
+
+    /*!
+     * @brief Выбор всех полностью поступивших кадров
+     * @param[in] head Начало поступивших отсчетов
+     * @param[in] tail Продолжение поступивших отсчетов
+     * @return Количество отсчетов, освобождаемых после анализа выбранных кадров
+     */
+    size_t planFrames(std::span<const float> head, std::span<const float> tail);
+
+    /// @brief Многопоточный анализ выбранных кадров и учет их пиков по порядку
+    void analyzeFrames(std::vector<syllable::Sound>& finished);
+
+    SpectralAnalyzer analyzer_;
+    CarrierTracker tracker_;
+    execution::Backend backend_  = execution::kScalar;
+    concurrency::TaskPool* pool_ = nullptr;
+    /// @brief Кадры, анализ которых распределяется по пулу потоков, и их пики
+    std::vector<PendingFrame> frames_;
+    std::vector<std::vector<Peak>> frame_peaks_;
+    /// @brief Анализаторы частей кадров (создаются при первой многопоточной обработке)
+    std::vector<SpectralAnalyzer> workers_;
+    unsigned sample_rate_ = 0;
+    /// @brief Количество еще не освобожденных отсчетов беседы
+    size_t remaining_ = 0;
+    /// @brief Номер следующего кадра анализа
+    size_t frame_ = 0;
+};
+
+}  // namespace spectrum
@@ -0,0 +1,157 @@
+/*!
+ * @file
+ * @brief Ограниченный кольцевой буфер без блокировок для одного писателя и одного читателя
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace concurrency {
+
+/// @brief Размер кэш-линии, по которому выравниваются индексы и ячейки кольца
+inline constexpr size_t kCacheLine = 64;
+
+/*!
+ * @brief Поведение писателя при заполненном буфере
+ */
+enum class OverflowPolicy {
+    kDropOldest,  ///< Вытеснить самый старый элемент и записать новый
+    kBlock,       ///< Ждать, пока читатель освободит место
+    kReject,      ///< Отказаться от записи нового элемента
+};
+
+/*!
+ * @brief Кольцевой буфер фиксированного размера для передачи данных между двумя потоками
+ * Каждая ячейка хранит собственный номер последовательности, поэтому запись и чтение элемента происходят атомарно
+ * целиком, а вытеснение старого элемента писателем безопасно относительно одновременного чтения.
+ * Память под элементы выделяется один раз при создании буфера.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /*!
+     * @brief Создание кольцевого буфера
+     * @param[in] capacity Емкость буфера, должна быть степенью двойки
+     * @param[in] policy Поведение при переполнении
+     */
+    explicit SpscRing(size_t capacity, OverflowPolicy policy = OverflowPolicy::kBlock)
+        : capacity_(capacity),
+          mask_(capacity - 1),
+          policy_(policy),
+          slots_(std::make_unique<Slot[]>(capacity)) {
+        if (capacity == 0 || (capacity & mask_) != 0)
+            throw std::invalid_argument("SpscRing capacity must be a power of two");
+        for (size_t iter = 0; iter < capacity_; iter++) slots_[iter].seq.store(iter, std::memory_order_relaxed);
+    }
+
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /*!
+     * @brief Запись элемента (вызывается только потоком-писателем)
+     * @param[in] value Записываемый элемент
+     * @return false, если элемент отброшен политикой kReject
+     */
+    bool push(T value) {
+        const size_t pos = head_.value.load(std::memory_order_relaxed);
+        Slot& slot       = slots_[pos & mask_];
+        while (slot.seq.load(std::memory_order_acquire) != pos) {
+            const size_t tail = tail_.value.load(std::memory_order_acquire);
+            if (pos - tail < capacity_) {
+                // Место уже освобождено, читатель дочитывает ячейку
+                std::this_thread::yield();
+                continue;
+            }
+            switch (policy_) {
+                case OverflowPolicy::kReject:
+                    rejected_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                case OverflowPolicy::kBlock:
+                    tail_.value.wait(tail, std::memory_order_acquire);
+                    break;
+                case OverflowPolicy::kDropOldest: {
+                    T dropped;
+                    if (tryPop(dropped))
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                } break;
+            }
+        }
+        slot.value = std::move(value);
+        slot.seq.store(pos + 1, std::memory_order_release);
+        head_.value.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * @brief Извлечение самого старого элемента без ожидания (вызывается потоком-читателем)
+     * @param[out] value Извлеченный элемент
+     * @return false, если буфер пуст
+     */
+    bool tryPop(T& value) {
+        size_t pos = tail_.value.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot     = slots_[pos & mask_];
+            const auto seq = static_cast<std::ptrdiff_t>(slot.seq.load(std::memory_order_acquire) - (pos + 1));
+            if (seq < 0)
+                return false;
+            if (seq > 0) {
+                pos = tail_.value.load(std::memory_order_relaxed);
+                continue;
+            }
+            // Ячейку может одновременно вытеснять писатель, поэтому захватываем ее через CAS
+            if (tail_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed)) {
+                value = std::move(slot.value);
+                slot.seq.store(pos + capacity_, std::memory_order_release);
+                tail_.value.notify_one();
+                return true;
+            }
+        }
+    }
+
+    /// @brief Приблизительное количество элементов в буфере
+    size_t size() const {
+        const size_t tail = tail_.value.load(std::memory_order_acquire);
+        const size_t head = head_.value.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return capacity_; }
+
+    /// @brief Количество элементов, вытесненных политикой kDropOldest
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /// @brief Количество элементов, отброшенных политикой kReject
+    size_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(kCacheLine) Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    struct alignas(kCacheLine) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    const OverflowPolicy policy_;
+    std::unique_ptr<Slot[]> slots_;
+    /// @brief Позиция записи (изменяется только писателем)
+    PaddedIndex head_;
+    /// @brief Позиция чтения (изменяется читателем и писателем при вытеснении)
+    PaddedIndex tail_;
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> rejected_{0};
+};
+
+}  // namespace concurrency
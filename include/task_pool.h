@@ -0,0 +1,166 @@
+/*!
+ * @file
+ * @brief Общий пул потоков с перехватом задач для выполнения независимых задач устройства
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "ring_queue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace concurrency {
+
+/*!
+ * @brief Пул рабочих потоков с перехватом задач (work stealing)
+ * У каждого рабочего потока своя очередь: собственные задачи он берет с конца (в порядке LIFO, пока данные еще в кэше),
+ * а освободившиеся потоки забирают задачи из начала чужих очередей. Поток, ожидающий результат, не простаивает,
+ * а выполняет задачи из очередей пула, поэтому ожидание изнутри задачи не приводит к взаимной блокировке.
+ * Пул разделяется между подсистемами устройства, чтобы не заводить отдельные потоки под каждую из них.
+ * parallelFor и invoke не выделяют память: обработчик передается по ссылке, а очереди задач растут только при
+ * заполнении. submit выделяет память под результат задачи.
+ */
+class TaskPool {
+public:
+    /*!
+     * @brief Создание пула
+     * @param[in] threads Количество рабочих потоков (0 - по числу аппаратных потоков)
+     */
+    explicit TaskPool(size_t threads = 0);
+
+    ~TaskPool();
+
+    TaskPool(const TaskPool&)            = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /*!
+     * @brief Постановка задачи в очередь
+     * @param[in] task Вызываемый объект без аргументов
+     * @return Будущий результат задачи
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    /*!
+     * @brief Ожидание результата задачи с выполнением задач пула во время ожидания
+     * @param[in] result Будущий результат задачи
+     * @return Результат задачи
+     */
+    template <typename T>
+    T wait(std::future<T>& result) {
+        while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!runPendingTask()) {
+                // Свободных задач нет, ожидаемая задача уже выполняется другим потоком
+                result.wait();
+                break;
+            }
+        }
+        return result.get();
+    }
+
+    /*!
+     * @brief Параллельная обработка диапазона индексов [0, count)
+     * Диапазон делится на части по grain элементов, вызывающий поток участвует в обработке.
+     * Возврат происходит после обработки всего диапазона.
+     * @param[in] count Количество элементов
+     * @param[in] grain Количество элементов в одной задаче
+     * @param[in] body Обработчик части диапазона [begin, end)
+     */
+    template <typename Body>
+    void parallelFor(size_t count, size_t grain, Body&& body) {
+        using Object          = std::remove_reference_t<Body>;
+        const RangeBody range = {.object = std::addressof(body),
+                                 .call   = [](const void* object, size_t begin, size_t end) {
+                                     (*static_cast<Object*>(const_cast<void*>(object)))(begin, end);
+                                 }};
+        runRange(count, grain, range);
+    }
+
+    /*!
+     * @brief Одновременное выполнение двух задач
+     * Вторая задача ставится в очередь пула, первую выполняет вызывающий поток. Возврат происходит после
+     * окончания обеих задач.
+     * @param[in] first Задача вызывающего потока
+     * @param[in] second Задача пула
+     */
+    template <typename First, typename Second>
+    void invoke(First&& first, Second&& second) {
+        parallelFor(2, 1, [&first, &second](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; task++) {
+                if (task == 0)
+                    first();
+                else
+                    second();
+            }
+        });
+    }
+
+    /*!
+     * @brief Выполнение одной задачи из очередей пула в вызывающем потоке
+     * @return false, если задач для выполнения нет
+     */
+    bool runPendingTask();
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    using Task = std::function<void()>;
+
+    /// @brief Обработчик части диапазона без владения: объект обработчика и функция его вызова
+    struct RangeBody {
+        const void* object;
+        void (*call)(const void* object, size_t begin, size_t end);
+    };
+
+    /// @brief Очередь задач рабочего потока
+    struct WorkQueue {
+        std::mutex mu;
+        RingQueue<Task> tasks{kInitialQueueCapacity};
+    };
+
+    void enqueue(Task task);
+
+    void runRange(size_t count, size_t grain, RangeBody body);
+
+    bool popLocal(size_t index, Task& task);
+
+    bool steal(size_t thief, Task& task);
+
+    void work(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    /// @brief Количество поставленных, но еще не взятых в работу задач
+    std::atomic<size_t> pending_{0};
+    /// @brief Номер очереди для задач, поставленных извне пула
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mu_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+
+    /// @brief Начальная емкость очереди задач рабочего потока
+    static constexpr size_t kInitialQueueCapacity = 64;
+
+    /// @brief Пул, которому принадлежит текущий поток (nullptr для внешних потоков)
+    static thread_local TaskPool* current_pool_;
+    /// @brief Номер рабочего потока в пуле
+    static thread_local size_t current_index_;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,97 @@
+/*!
+ * @file
+ * @brief Трассировка выполнения: события начала и окончания участков кода по потокам и выгрузка в Chrome Trace
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trace {
+
+/// @brief Трассировка собрана (опция сборки ENABLE_TRACING); без нее TRACE_SCOPE ничего не делает
+#ifdef TRACING_ENABLED
+inline constexpr bool kCompiled = true;
+#else
+inline constexpr bool kCompiled = false;
+#endif
+
+/// @brief Количество событий, хранимых для каждого потока; более старые события перезаписываются
+inline constexpr size_t kEventsPerThread = 1 << 15;
+
+/// @brief Вид события
+enum Phase : uint8_t {
+    kBegin = 0,  ///< Начало участка
+    kEnd,        ///< Окончание участка
+};
+
+/// @brief Признак записи событий; читается при входе в каждый участок
+inline std::atomic<bool> recording{false};
+
+/*!
+ * @brief Запись события текущего потока
+ * События пишутся в кольцевой буфер потока без блокировок, буфер выделяется при первом событии потока.
+ * @param[in] name Название участка, строка со статическим временем жизни
+ * @param[in] phase Вид события
+ */
+void record(const char* name, Phase phase);
+
+/*!
+ * @brief Название текущего потока в трассе
+ * @param[in] name Название потока
+ */
+void nameThread(const std::string& name);
+
+/*!
+ * @brief Включение или выключение записи событий
+ * При включении ранее записанные события отбрасываются.
+ */
+void setRecording(bool value);
+
+/*!
+ * @brief Выгрузка записанных событий в формате Chrome Trace Event (JSON)
+ * Файл открывается в chrome://tracing и ui.perfetto.dev. Выгрузка не останавливает запись; события,
+ * перезаписанные во время выгрузки, пропускаются.
+ * @param[in] path Путь к файлу
+ * @return false, если файл не удалось записать
+ */
+bool dump(const std::string& path);
+
+/*!
+ * @brief Участок трассы: событие начала при создании и окончания при уничтожении
+ * Если запись выключена при входе в участок, участок не записывается целиком.
+ */
+class Scope {
+public:
+    explicit Scope(const char* name) : name_(recording.load(std::memory_order_relaxed) ? name : nullptr) {
+        if (name_)
+            record(name_, kBegin);
+    }
+
+    ~Scope() {
+        if (name_)
+            record(name_, kEnd);
+    }
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+};
+
+}  // namespace trace
+
+#define TRACE_CONCAT_IMPL(first, second) first##second
+#define TRACE_CONCAT(first, second)      TRACE_CONCAT_IMPL(first, second)
+
+/// @brief Трассировка участка до конца текущей области видимости: TRACE_SCOPE("Translator::translate");
+#ifdef TRACING_ENABLED
+#define TRACE_SCOPE(name) ::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
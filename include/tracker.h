@@ -0,0 +1,104 @@
+/*!
+ * @file
+ * @brief Сопровождение животных по последовательным кадрам: постоянные номера животных между кадрами
+ * @author Степанов Михаил, Казаченко Роман
+ * @version 1.0
+ */
+#pragma once
+
+#include "animal_types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tracking {
+
+/// @brief Трек - одно животное, прослеженное по последовательным кадрам
+struct Track {
+    uint64_t id = 0;  ///< Постоянный номер животного; 0 - ячейка свободна
+    pantomime::Pantomime body;
+    syllable::Sound sound;
+    size_t missed = 0;  ///< Количество кадров подряд, в которых животное не найдено
+};
+
+/*!
+ * @brief Сопровождение нескольких животных
+ * Животные кадра сопоставляются с треками предыдущих кадров по размеру, жесту, частоте и громкости звука.
+ * Пары сопоставляются жадно в порядке возрастания расстояния между признаками; животные со звуком горла другого
+ * вида и слишком далекие по признакам получают новый трек. Трек, не найденный kMaxMissed кадров подряд, удаляется.
+ * Треки хранятся в ячейках, номер ячейки трека не меняется за время его жизни; буферы переиспользуются между кадрами.
+ * Сопоставление выполняет один поток, счетчики можно читать из любого.
+ */
+class Tracker {
+public:
+    /// @brief Счетчики сопровождения
+    struct Stats {
+        uint64_t frames;   ///< Обработано кадров
+        uint64_t matched;  ///< Животных, найденных в предыдущих кадрах
+        uint64_t created;  ///< Новых треков
+        uint64_t lost;     ///< Удаленных треков
+    };
+
+    /*!
+     * @brief Сопоставление животных очередного кадра с треками
+     * @param[in] pantomime Пантомимика животных кадра
+     * @param[in] sound Звуки животных кадра, по одному на каждое животное
+     * @param[out] slots Номер ячейки трека каждого животного
+     */
+    void update(std::span<const pantomime::Pantomime> pantomime, std::span<const syllable::Sound> sound,
+                std::vector<size_t>& slots);
+
+    const Track& track(size_t slot) const { return tracks_[slot]; }
+
+    /// @brief Количество ячеек треков (включая свободные); номера ячеек меньше этого значения
+    size_t capacity() const { return tracks_.size(); }
+
+    /// @brief Счетчики; допустимо читать из другого потока во время сопровождения
+    Stats stats() const {
+        return (Stats){.frames  = stats_.frames.load(std::memory_order_relaxed),
+                       .matched = stats_.matched.load(std::memory_order_relaxed),
+                       .created = stats_.created.load(std::memory_order_relaxed),
+                       .lost    = stats_.lost.load(std::memory_order_relaxed)};
+    }
+
+    /// @brief Максимальное расстояние между признаками животного и трека, при котором они сопоставляются
+    static constexpr double kMaxDistance = 1.5;
+    /// @brief Количество кадров, после которого не найденный трек удаляется
+    static constexpr size_t kMaxMissed = 3;
+
+private:
+    /// @brief Пара животное - трек, допустимая для сопоставления
+    struct Candidate {
+        double distance;
+        size_t animal;
+        size_t slot;
+    };
+
+    /// @brief Расстояние между признаками; бесконечность, если животное не может быть этим треком
+    static double distance(const Track& track, const pantomime::Pantomime& body, const syllable::Sound& sound);
+
+    std::vector<Track> tracks_;
+    std::vector<size_t> free_;
+    std::vector<Candidate> candidates_;
+    /// @brief Трек уже сопоставлен в текущем кадре
+    std::vector<bool> taken_;
+    uint64_t next_id_ = 1;
+    /// @brief Счетчики (см. Stats)
+    struct {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> matched{0};
+        std::atomic<uint64_t> created{0};
+        std::atomic<uint64_t> lost{0};
+    } stats_;
+
+    /// @brief Относительная разница размера, частоты и разница громкости (дБ), дающие расстояние 1
+    static constexpr double kSizeScale      = 0.25;
+    static constexpr double kFrequencyScale = 0.25;
+    static constexpr double kVolumeScale    = 10;
+    /// @brief Прибавка к расстоянию при смене жеста
+    static constexpr double kGesturePenalty = 0.5;
+};
+
+}  // namespace tracking
@@ -6,10 +6,29 @@
  */
 #pragma once
 
+#include "animal_classifier.h"
 #include "animal_types.h"
+#include "depth_map.h"
+#include "execution.h"
+#include "feature_batch.h"
+#include "frame_bus.h"
+#include "latency.h"
+#include "memo_cache.h"
+#include "message_catalog.h"
+#include "output.h"
+#include "pipeline.h"
+#include "readiness_event.h"
+#include "session.h"
+#include "spectrum.h"
+#include "task_pool.h"
+#include "tracker.h"
+#include <chrono>
 #include <condition_variable>
-#include <deque>
-#include <iostream>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
 
 namespace translator {
 
@@ -21,12 +40,17 @@ class Sensor {
 public:
     /*!
      * @brief Создание модуля обработки входных сигнаов
-     * @param[in] pantomime Имитация видео-потока
-     * @param[in] sound Имитация аудио-потока
-     * @param[in] reactive_cv Триггер на поступление данных.
+     * @param[in] frames Шина кадров от всех источников
+     * @param[in] audio Поток отсчетов микрофона
+     * @param[in] pool Общий пул потоков для параллельной обработки видео и звука
+     * @param[in] backends Реализации стадий обработки видео и звука
      */
-    Sensor(std::deque<pantomime::Video>& pantomime, std::deque<syllable::Noise>& sound, bool& reactive_cv_)
-        : primary_sensor(pantomime, sound, reactive_cv_) {}
+    Sensor(animal::FrameBus& frames, animal::AudioRing& audio, concurrency::TaskPool& pool,
+           const execution::Backends& backends)
+        : primary_sensor(frames),
+          video_formatter(pool, backends),
+          sound_formatter(audio, pool, backends),
+          pool(pool) {}
 
     /*!
      * @brief Ожидание поступление минимального набора данных и их обработки
@@ -36,6 +60,49 @@ public:
      */
     animal::PreparedData prepareBatchOfData();
 
+    /*!
+     * @brief Первичное чтение данных с датчиков без их обработки
+     * @param[in] timeout Максимальное время ожидания данных
+     * @return Упакованные первичные данные; ready = false, если данные не поступили за отведенное время
+     */
+    animal::PackedData collectData(std::chrono::milliseconds timeout = kWaitTimeout) {
+        return primary_sensor.waitAndPackData(timeout);
+    }
+
+    /*!
+     * @brief Первичное чтение уже поступивших данных без ожидания
+     * @return Упакованные первичные данные; ready = false, если данных нет
+     */
+    animal::PackedData tryCollectData() { return primary_sensor.tryPackData(); }
+
+    /*!
+     * @brief Обработка первичных данных видео- и аудио-подсистемами
+     * @param[in] packed_data Упакованные первичные данные
+     * @return Подготовленные для переводчика данные
+     */
+    animal::PreparedData prepareData(animal::PackedData& packed_data);
+
+    /*!
+     * @brief Обработка кадра записанного сеанса видео- и аудио-подсистемами
+     * Карта диспаритета и звук разбираются прямо в памяти записи. Фигуры, звуки и виды записываются в буферы
+     * prepared_data, поэтому при повторном использовании одних и тех же подготовленных данных для кадров записи
+     * память не выделяется.
+     * @param[in] frame Кадр записанного сеанса
+     * @param[in,out] prepared_data Подготовленные для переводчика данные; их буферы переиспользуются
+     */
+    void prepareData(const session::FrameView& frame, animal::PreparedData& prepared_data);
+
+    /*!
+     * @brief Выбор режима обработки видео и звука
+     * @param[in] value true - видео и звук обрабатываются одновременно в общем пуле потоков, false - последовательно
+     */
+    void setParallelFormatting(bool value) { parallel_formatting_ = value; }
+
+    bool parallelFormatting() const { return parallel_formatting_; }
+
+    /// @brief Максимальное время ожидания окончания беседы
+    static constexpr std::chrono::milliseconds kWaitTimeout{3000};
+
 private:
     /*!
      * @brief Подсистема первичных датчиков видео и звука.
@@ -45,27 +112,28 @@ private:
     public:
         /*!
          * @brief Создание модуля первичных датчиков.
-         * @param[in] pantomime Имитация видео-потока
-         * @param[in] sound Имитация аудио-потока
-         * @param[in] reactive_cv Триггер на поступление данных.
+         * @param[in] frames Шина кадров от всех источников
          */
-        PrimarySensor(std::deque<pantomime::Video>& pantomime, std::deque<syllable::Noise>& sound, bool& reactive_cv_)
-            : pantomime(pantomime),
-              sound(sound),
-              cv_(reactive_cv_) {}
+        explicit PrimarySensor(animal::FrameBus& frames) : frames(frames) {}
 
         /*!
          * @brief Ожидание поступления атомарных данных (Первичное чтение).
-         * Ожидание происходит до тех пор пока не будет получено минимально необходимое количество информации
+         * Ожидание происходит до тех пор пока не будет получено минимально необходимое количество информации,
+         * но не дольше timeout
+         * @param[in] timeout Максимальное время ожидания данных
          * @return Возвращаемые с датчиков данные. Разделены на аудио-данные и видео-данные. К видео-данным
          * дополнительно прилагается растояние до центрального пикселя на первом кадре
          */
-        animal::PackedData waitAndPackData();
+        animal::PackedData waitAndPackData(std::chrono::milliseconds timeout);
+
+        /// @brief Упаковка уже поступивших данных без ожидания
+        animal::PackedData tryPackData();
 
     private:
-        std::deque<pantomime::Video>& pantomime;
-        std::deque<syllable::Noise>& sound;
-        bool& cv_;
+        /// @brief Упаковка кадра в первичные данные
+        static animal::PackedData pack(animal::Frame& frame);
+
+        animal::FrameBus& frames;
     };
 
     /*!
@@ -76,30 +144,50 @@ private:
     public:
         /*!
          * @brief Создание модуля обработки видео.
+         * @param[in] pool Общий пул потоков для многопоточного построения карты глубины
+         * @param[in] backends Реализации стадий обработки
          */
-        VideoFormatter() {}
+        VideoFormatter(concurrency::TaskPool& pool, const execution::Backends& backends)
+            : backends(backends),
+              mapper(&pool) {}
 
         /*!
          * @brief Передача полученных видео-данных на обработку.
          * Обработчик строит карту глубины и маскирует объекты для разделения животных и получение их эмоций.
+         * Если карты диспаритета нет, используются предзаготовленные фигуры без изменений.
+         * Реализация построения карты глубины выбирается один раз на кадр.
+         * @param[in] video Кадр видео
+         * @param[in] distance Показания дальномера, м
+         * @param[in] figures Предзаготовленные фигуры кадра; уточняются на месте и возвращаются без копирования
          * @return Разделенные существа на видео
          */
-        std::vector<pantomime::Pantomime> splitAndClassify(pantomime::Video& video, double distance);
+        std::vector<pantomime::Pantomime> splitAndClassify(const pantomime::VideoView& video, double distance,
+                                                           std::vector<pantomime::Pantomime> figures);
 
     private:
         /// @brief Карта глубины с поправкой на расстояние
         struct DeepMap {
-            // Пустая структура-заглушка для создание карты глубины
+            /// @brief Предзаготовленные фигуры в порядке слева направо
             std::vector<pantomime::Pantomime> pantomime;
+            /// @brief Связные области карты глубины в порядке слева направо
+            std::span<const depth::Component> components;
         };
 
         /// @brief Построение карты глубины
-        /// @todo Реальный алгоритм основан на использовании нейронных сетей и алгоритмов машинного обучения
-        DeepMap buildDeepMap(pantomime::Video& video, double distance);
+        DeepMap buildDeepMap(const pantomime::VideoView& video, double distance, execution::Backend backend,
+                             std::vector<pantomime::Pantomime>& figures);
 
         /// @brief Выделение визуальных признаков
-        /// @todo Реальный алгоритм по карте глубины разделяет объекты на изображении и получает их визуальные признаки
+        /// Каждой фигуре сопоставляется крупнейшая область в ее столбце кадра, размер фигуры измеряется по области.
+        /// @todo Выражение морды, поза и жесты распознаются при помощи нейронных сетей
         std::vector<pantomime::Pantomime> getVisualIndication(DeepMap& deep_map);
+
+        /// @brief Реализации стадий обработки
+        const execution::Backends& backends;
+        /// @brief Построитель карты глубины
+        depth::DepthMapper mapper;
+        /// @brief Крупнейшая область столбца каждой фигуры (буфер переиспользуется между кадрами)
+        std::vector<const depth::Component*> matched;
     };
 
     /*!
@@ -110,30 +198,68 @@ private:
     public:
         /*!
          * @brief Создание модуля обработки звука
+         * @param[in] audio Поток отсчетов микрофона
+         * @param[in] pool Общий пул потоков для многопоточного спектрального анализа
+         * @param[in] backends Реализации стадий обработки
          */
-        SoundFormatter() {}
+        SoundFormatter(animal::AudioRing& audio, concurrency::TaskPool& pool, const execution::Backends& backends)
+            : audio(audio),
+              pool(pool),
+              backends(backends) {}
 
         /*!
          * @brief Передача полученных аудио-данных на обработку.
          * Обработчик делит данные на несущие и по частоте и громкости относит звукии соответствующим животным.
+         * Звук беседы читается из потока микрофона по мере поступления, поэтому обработка идет одновременно с
+         * записью. Если записанного звука нет, используются предзаготовленные звуки без изменений.
          * @return Разделенные несущие на аудио
-         * @todo Не реализована передача аудио. Данные поступает в предзаготовленном виде
          */
         std::vector<syllable::Sound> devideCarrier(syllable::Noise& noise);
 
+        /*!
+         * @brief Обработка беседы, звук которой уже записан целиком
+         * @param[in] noise Звук беседы
+         * @param[in] sound Буфер, в который записываются звуки беседы (его память переиспользуется)
+         * @return Разделенные несущие на аудио
+         */
+        std::vector<syllable::Sound> devideCarrier(const syllable::NoiseView& noise,
+                                                   std::vector<syllable::Sound> sound);
+
     private:
         struct Carrier {
-            // Пустая структура-заглушка для создание несущей
+            /// @brief Предзаготовленные звуки
             std::vector<syllable::Sound> sound;
+            /// @brief Признак того, что звук уже уточнен по измеренной несущей
+            std::vector<bool> refined;
+            /// @brief Несущие, выделенные спектральным анализом и еще не сопоставленные звукам
+            std::vector<syllable::Sound> measured;
+            /// @brief Допустимое отклонение частоты несущей от частоты звука, Гц
+            double tolerance = 0;
         };
 
+        /// @brief Пропуск звука бесед, кадры которых были отброшены, до начала текущей беседы
+        bool seekCarrier(size_t sample_begin);
+
         /// @brief Разделение шума на составные части по чаастотным несущим.
-        /// @todo Реальный алгоритм основан на частотном анализе звука
-        Carrier splitCarrier(syllable::Noise& noise);
+        /// Анализирует все поступившие кадры звука и ждет поступления следующего кадра.
+        /// @return false, если беседа проанализирована целиком или поток микрофона закрыт
+        bool splitCarrier(Carrier& carrier);
 
         /// @brief Выделение звуковых признаков по несущим.
-        /// @todo Реальный алгоритм основан на восстановлении звуковых признаков при помощи нейронных сетей
-        std::vector<syllable::Sound> buildCarrier(Carrier);
+        /// Частота, громкость и длительность звука уточняются по ближайшей к нему завершившейся несущей.
+        /// @todo Вид звука (гортань, горло) восстанавливается при помощи нейронных сетей
+        void buildCarrier(Carrier& carrier);
+
+        /// @brief Поток отсчетов микрофона
+        animal::AudioRing& audio;
+        /// @brief Общий пул потоков
+        concurrency::TaskPool& pool;
+        /// @brief Реализации стадий обработки
+        const execution::Backends& backends;
+        /// @brief Потоковый спектральный анализатор
+        spectrum::StreamingAnalyzer analyzer;
+        /// @brief Разбираемая беседа
+        Carrier carrier;
     };
 
     /// @brief Первичные датчики (первичное чтение)
@@ -142,6 +268,10 @@ private:
     VideoFormatter video_formatter;
     /// @brief Обработчик аудио-данных
     SoundFormatter sound_formatter;
+    /// @brief Общий пул потоков
+    concurrency::TaskPool& pool;
+    /// @brief Одновременная обработка видео и звука
+    bool parallel_formatting_ = true;
 };
 
 /*!
@@ -152,25 +282,98 @@ class Translator {
 public:
     /*!
      * @brief Создание модуля переводчика
+     * @param[in] pool Общий пул потоков для параллельного перевода животных в кадре
+     * @param[in] backends Реализации стадий классификации и перевода
      */
-    Translator() {}
+    Translator(concurrency::TaskPool& pool, const execution::Backends& backends) : pool(pool), backends(backends) {}
 
     /*!
      * @brief Перевод с животного на человеческий
-     * @param[in] video Предобработанное видео
-     * @param[in] sound Предобработанный звук
-     * @param[in] types Заглушка в виде типов животных
-     * @return Набор языковых признаков и переведенных сообщений от животных
+     * Промежуточные буферы и результат переиспользуются между вызовами, поэтому после прогрева перевод кадра
+     * не выделяет память.
+     * @param[in] prepared_data Предобработанные видео и звук вместе с заглушкой в виде типов животных
+     * @return Набор языковых признаков и переведенных сообщений от животных; действителен до следующего вызова
+     */
+    std::span<const animal::DecodedAnimalCharacteristic> translate(animal::PreparedData& prepared_data);
+
+    /*!
+     * @brief Пакетный перевод нескольких кадров за один вызов
+     * Животные всех кадров собираются в общий список, и каждая стадия перевода (классификация, настроение,
+     * потребность, шаблон сообщения) выполняется одним циклом по всему пакету. Промежуточные буферы переводчика
+     * и выходные массивы переиспользуются между вызовами.
+     * @param[in] frames Предобработанные кадры
+     * @param[out] decoded Переводы по каждому кадру в порядке следования кадров
+     */
+    void translateBatch(std::span<animal::PreparedData> frames,
+                        std::vector<std::vector<animal::DecodedAnimalCharacteristic>>& decoded);
+
+    /// @brief Отключение сообщений о ходе перевода (например, когда переводчиков на одном узле много)
+    void setQuiet(bool value) { quiet_ = value; }
+
+    /*!
+     * @brief Выбор языка сообщений
+     * Язык запоминается по названию и заново ищется в каталоге после каждой его замены. Выбор допустим во время
+     * перевода и вступает в силу со следующего сообщения.
+     * @param[in] name Название языка
+     * @return false, если такого языка в текущем каталоге нет; выбор при этом не меняется
+     */
+    bool setLocale(std::string_view name);
+
+    /// @brief Название языка сообщений в текущем каталоге
+    std::string_view localeName() const;
+
+    /*!
+     * @brief Включение или выключение кэша прогнозов
+     * Выключенный кэш не читается и не пополняется, записи и счетчики сохраняются.
+     */
+    void setMemoization(bool value) { memoize_.store(value, std::memory_order_relaxed); }
+
+    bool memoization() const { return memoize_.load(std::memory_order_relaxed); }
+
+    /// @brief Счетчики кэша прогнозов
+    auto predictionStats() { return predictions.stats(); }
+
+    /// @brief Очистка кэша прогнозов и сброс его счетчиков
+    void resetPredictions() { predictions.clear(); }
+
+    /*!
+     * @brief Включение или выключение инкрементального перевода
+     * При включенном режиме животные сопровождаются между кадрами, и животные с неизменившимися признаками
+     * не переводятся заново.
+     */
+    void setIncremental(bool value) { incremental_.store(value, std::memory_order_relaxed); }
+
+    bool incremental() const { return incremental_.load(std::memory_order_relaxed); }
+
+    /// @brief Счетчики сопровождения
+    tracking::Tracker::Stats trackingStats() const { return tracker.stats(); }
+
+    /// @brief Количество животных, перевод которых взят из их трека
+    uint64_t reusedTranslations() const { return reused_.load(std::memory_order_relaxed); }
+
+    /*!
+     * @brief Включение или выключение классификации, специализированной по видам
+     * При включенном режиме скалярный классификатор оценивает виды кодом, в котором границы признаков вида -
+     * константы времени компиляции; при выключенном - по таблицам признаков. Результаты обоих режимов совпадают.
+     */
+    void setSpecialization(bool value) { specialize_.store(value, std::memory_order_relaxed); }
+
+    bool specialization() const { return specialize_.load(std::memory_order_relaxed); }
+
+    /*!
+     * @brief Замер скалярной классификации по таблицам признаков и кодом, специализированным по видам
+     * Случайные животные всех видов классифицируются обоими способами; выводится скорость каждого способа и
+     * совпадение результатов.
+     * @param[in] animal_count Количество животных
      */
-    std::vector<animal::DecodedAnimalCharacteristic> translate(animal::PreparedData& prepared_data,
-                                                               std::vector<animal::AnimalType> types);
+    void runSpeciesBenchmark(size_t animal_count);
 
 private:
     /*!
      * @brief Подготовка первичных языковых сигналов
      * @param[in] video Предобработанное видео
      * @param[in] sound Предобработанное аудио
-     * @param[in] types Очередь типов животных для заглушки
+     * @param[in] types Виды животных кадра, определенные классификатором
      * @param[in] iter Порядковый номер животного
      */
     animal::DecodedAnimalCharacteristic predictAnimalCharacteristic(std::vector<pantomime::Pantomime>& video,
@@ -197,9 +400,11 @@ private:
 
     /*!
      * @brief Классификация животного
+     * Все животные кадра классифицируются одним пакетом (см. AnimalClassifier) до перевода,
+     * здесь забирается результат для конкретного животного.
      * @param[in] pantomime Пантомимика животного
      * @param[in] sound Соотнесенный звук животного
-     * @param[in] types Очередь типов животных для заглушки
+     * @param[in] types Виды животных кадра, определенные классификатором
      * @param[in] iter Порядковый номер животного
      */
     animal::AnimalType predictAnimal(pantomime::Pantomime& pantomime, syllable::Sound& sound,
@@ -244,30 +449,7 @@ private:
      */
     Need translateNeed(animal::DecodedAnimalCharacteristic& animal);
 
-    enum MessageTemplate {
-        kGoulash = 0,
-        kLorem,
-        kAfraid,
-        kPlay,
-        kMaxMessageTemplate,
-    };
-
-    enum Locale {
-        RU,
-        EN,
-    };
-
-    std::map<MessageTemplate, std::string> messages_ru{{kGoulash, "Хочу гуляш"},
-                                                       {kLorem, "Lorem Ipsum"},
-                                                       {kAfraid, "Бойся меня, кожаный мешок"},
-                                                       {kPlay, "Давай играть"}};
-
-    std::map<MessageTemplate, std::string> messages_en{{kGoulash, "I want goulash"},
-                                                       {kLorem, "Lorem Ipsum"},
-                                                       {kAfraid, "Afraid of me, leather bag"},
-                                                       {kPlay, "Let's play"}};
-
-    std::map<Locale, std::map<MessageTemplate, std::string>> message_locale{{RU, messages_ru}, {EN, messages_en}};
+    using MessageTemplate = messages::Template;
 
     /*!
      * @brief Выделение шаблона человеческой языковой конструкции
@@ -281,16 +463,169 @@ private:
     /*!
      * @brief Подготовка сообщения переводчика
      * @param[in] message_template шаблон языковой конструкции
+     * @return Текст шаблона на выбранном языке из текущего каталога сообщений
      */
-    std::string translateMessage(MessageTemplate message_template);
+    std::string_view translateMessage(MessageTemplate message_template);
+
+    /// @brief Результат цепочки прогнозов по языковым признакам животного
+    struct Prediction {
+        Need need;
+        MessageTemplate message_template;
+    };
 
     /*!
-     * @brief Составление подходящей фразы на необходимом языке
-     * @param[in] pantomime Пантомимика животного
-     * @param[in] sound Соотнесенный звук животного
+     * @brief Прогноз потребности и шаблона сообщения с кэшированием
+     * Цепочка настроение - потребность - шаблон зависит только от квантованных признаков животного (см. featureKey),
+     * поэтому повторяющиеся жесты и звуки берут готовый прогноз из кэша.
+     * @param[in] animal Животное с определенными видом, пантомимикой и звуком
+     */
+    Prediction predict(animal::DecodedAnimalCharacteristic& animal);
+
+    /*!
+     * @brief Ключ кэша прогнозов
+     * Вид, выражение морды, поза, жест, звуки гортани и горла упаковываются как есть, частота квантуется
+     * по полутонам, громкость - по kVolumeStep дБ.
+     * @param[in] type Вид животного; animal::MaxAnimalType, если вид еще не определен
+     */
+    static uint64_t featureKey(animal::AnimalType type, const pantomime::Pantomime& body,
+                               const syllable::Sound& sound);
+
+    /*!
+     * @brief Сопровождение животных кадра и перенос переводов неизменившихся животных
+     * Животное, признаки которого не изменились с последнего перевода его трека, получает прежний вид и шаблон
+     * сообщения. Размер, громкость и частота сравниваются точно: классификатор вида не квантует их. Остальные
+     * животные добавляются в пакет перевода (scratch). Если прежний перевод трека сам еще в пакете, животное
+     * попадает в scratch.deferred и копируется после перевода пакета.
+     * @param[in] data Кадр
+     * @param[in] frame Номер кадра в пакете
+     * @param[out] decoded Переводы животных кадра
+     */
+    void collectChanged(const animal::PreparedData& data, size_t frame,
+                        std::span<animal::DecodedAnimalCharacteristic> decoded);
+
+    /*!
+     * @brief Запоминание перевода животного пакета в его треке
+     * @param[in] iter Порядковый номер животного в пакете
      * @param[in] type Вид животного
+     * @param[in] message_template Шаблон сообщения
+     */
+    void rememberTracked(size_t iter, animal::AnimalType type, MessageTemplate message_template);
+
+    /*!
+     * @brief Классификация пакета животных выбранной реализацией
+     * Скалярная реализация не использует векторные инструкции, векторная использует лучший набор инструкций
+     * процессора, многопоточная распределяет части пакета по пулу потоков.
      */
-    std::string predictMessage(animal::DecodedAnimalCharacteristic& animal, Need& need);
+    void classifyBatch(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                       std::span<animal::AnimalType> types);
+
+    /*!
+     * @brief Обработка животных пакета
+     * @param[in] count Количество животных
+     * @param[in] parallel Распределять большие пакеты по пулу потоков
+     * @param[in] body Обработчик одного животного
+     */
+    void forEachAnimal(size_t count, bool parallel, const std::function<void(size_t)>& body);
+
+    /// @brief Промежуточные результаты пакетного перевода, разложенные по стадиям
+    struct BatchScratch {
+        std::vector<size_t> frame;   ///< Номер кадра животного
+        std::vector<size_t> index;   ///< Порядковый номер животного в кадре
+        pantomime::PantomimeBatch pantomime;
+        syllable::SoundBatch sound;
+        std::vector<animal::AnimalType> types;
+        std::vector<animal::DecodedAnimalCharacteristic> animals;
+        std::vector<Mood> moods;
+        std::vector<Need> needs;
+        std::vector<MessageTemplate> templates;
+        std::vector<uint64_t> keys;   ///< Ключи кэша прогнозов
+        std::vector<size_t> misses;   ///< Номера животных, прогнозов для которых нет в кэше
+        std::vector<size_t> slots;    ///< Ячейка трека животного (kNoTrack, если сопровождение выключено)
+        /// @brief Животные, прежний перевод которых переводится в этом же пакете: кадр, номер в кадре, номер в пакете
+        std::vector<std::array<size_t, 3>> deferred;
+    };
+
+    BatchScratch scratch;
+
+    /// @brief Результат перевода одного кадра
+    std::vector<animal::DecodedAnimalCharacteristic> frame_decoded;
+
+    /// @brief Последний перевод животного; хранится по номеру ячейки его трека
+    struct TrackedTranslation {
+        uint64_t id = 0;                   ///< Номер животного, которому принадлежит перевод
+        uint64_t key;                      ///< Квантованные признаки животного при переводе (вид не определен)
+        long size;                         ///< Точные признаки классификатора вида при переводе
+        int volume;
+        double frequency;
+        animal::AnimalType type;
+        MessageTemplate message_template;
+        size_t pending = kNoTrack;         ///< Номер животного в переводимом пакете, пока перевод не готов
+    };
+
+    /// @brief Сопровождение животных между кадрами
+    tracking::Tracker tracker;
+    std::vector<size_t> track_slots;
+    std::vector<TrackedTranslation> tracked;
+    /// @brief Повторно использовано переводов неизменившихся животных
+    std::atomic<uint64_t> reused_{0};
+    /// @brief Неизменившиеся животные не переводятся заново
+    std::atomic<bool> incremental_{true};
+
+    /// @brief Классификатор вида животного
+    AnimalClassifier classifier;
+
+    /// @brief Общий пул потоков
+    concurrency::TaskPool& pool;
+
+    /// @brief Реализации стадий
+    const execution::Backends& backends;
+
+    /// @brief Сообщения о ходе перевода отключены
+    bool quiet_ = false;
+
+    /// @brief Номер языка в каталоге с номером generation
+    struct ResolvedLocale {
+        uint32_t generation;
+        messages::Locale locale;
+    };
+
+    /*!
+     * @brief Номер выбранного языка в каталоге
+     * Номер ищется по названию языка, только если каталог сменился с прошлого поиска.
+     * @param[in] catalog Текущий каталог сообщений
+     * @return Номер языка; первый язык каталога, если выбранного языка в нем нет
+     */
+    messages::Locale resolveLocale(const messages::Catalog& catalog) const;
+
+    /// @brief Название языка сообщений; пустое - первый язык каталога
+    std::string locale_name_;
+    mutable std::mutex locale_mu_;
+    /// @brief Номер языка в последнем каталоге, в котором он искался
+    mutable std::atomic<ResolvedLocale> resolved_locale_{ResolvedLocale{.generation = kUnresolved, .locale = 0}};
+
+    /// @brief Кэш прогнозов по квантованным признакам
+    concurrency::MemoCache<Prediction> predictions{kPredictionCacheSize};
+
+    /// @brief Прогнозы берутся из кэша
+    std::atomic<bool> memoize_{true};
+
+    /// @brief Скалярная классификация выполняется кодом, специализированным по виду
+    std::atomic<bool> specialize_{true};
+
+    /// @brief Количество животных в кадре, начиная с которого перевод распределяется по пулу потоков
+    static constexpr size_t kParallelThreshold = 8;
+    /// @brief Количество животных в одной задаче пула
+    static constexpr size_t kAnimalsPerTask = 4;
+    /// @brief Количество животных в одной задаче многопоточной классификации
+    static constexpr size_t kClassifyPerTask = 256;
+    /// @brief Животное без трека
+    static constexpr size_t kNoTrack = SIZE_MAX;
+    /// @brief Номер каталога, в котором язык еще не искался
+    static constexpr uint32_t kUnresolved = UINT32_MAX;
+    /// @brief Количество записей кэша прогнозов
+    static constexpr size_t kPredictionCacheSize = 1024;
+    /// @brief Шаг квантования громкости в ключе кэша прогнозов, дБ
+    static constexpr int kVolumeStep = 5;
 };
 
 /*!
@@ -302,16 +637,21 @@ public:
     /*!
      * @brief Создание модуля монитора
      */
-    Monitor();
+    Monitor() {}
 
     /*!
      * @brief Вывод полученной информации на экран
-     * @param[in] Массив переведнных сообщений с определенными признаками животных
+     * Вывод асинхронный: сообщения ставятся в очередь общего вывода и печатаются его потоком.
+     * @param[in] animals Массив переведнных сообщений с определенными признаками животных
      */
-    void display(std::vector<animal::DecodedAnimalCharacteristic> animals);
+    void display(std::span<const animal::DecodedAnimalCharacteristic> animals);
+};
 
-private:
-    std::map<animal::AnimalType, std::string> animal_names;
+/// @brief Длительность обработки беседы
+struct ListenTiming {
+    double measured;     ///< Измеренная длительность обработки, с
+    double projected;    ///< Смоделированная длительность на аппаратуре устройства, с (0, если проекция выключена)
+    size_t allocations;  ///< Количество выделений динамической памяти за время обработки (во всех потоках)
 };
 
 /*!
@@ -321,11 +661,14 @@ class AnimalTranslatinator {
 public:
     /*!
      * @brief Создание модели переводчика
-     * @param[in] reactive_cv Триггер на поступление данных.
+     * @param[in] frames Шина входных кадров
+     * @param[in] audio Входной поток отсчетов микрофона
+     * @param[in] pool Общий пул потоков
      */
-    AnimalTranslatinator(std::deque<pantomime::Video>& pantomime, std::deque<syllable::Noise>& sound,
-                         bool& reactive_cv_)
-        : sensor(pantomime, sound, reactive_cv_) {}
+    AnimalTranslatinator(animal::FrameBus& frames, animal::AudioRing& audio, concurrency::TaskPool& pool)
+        : sensor(frames, audio, pool, backends_),
+          translator(pool, backends_),
+          pipeline(sensor, translator, monitor) {}
 
     /*!
      * @brief Нажатие на кнопку включения
@@ -339,44 +682,183 @@ public:
 
     /*!
      * @brief Нажатие на кнопку прослушивания
-     * @param[in] pantomime Входной поток видео
-     * @param[in] sound Входной поток аудио
-     * @param[in] types Входной поток типов животных (для заглушки декодирования)
+     * @return Измеренная длительность обработки беседы и ее проекция на аппаратуру устройства
      */
-    double startListening(std::deque<animal::AnimalDecodingStub>& types);
+    ListenTiming startListening();
 
-    void setHardwareVideo(bool value) { hardware_video_ = value; };
+    /*!
+     * @brief Включение потокового режима
+     * Датчики, обработчики, переводчик и монитор запускаются как одновременно работающие стадии конвейера.
+     */
+    void startStreaming();
 
-    void setHardwareAudio(bool value) { hardware_audio_ = value; };
+    /*!
+     * @brief Выключение потокового режима
+     */
+    void stopStreaming();
 
-    void setHardwareClassify(long value) {
-        std::cout << "Изменено аппаратное исполнение" << std::endl;
-        hardware_classify = value;
-    };
+    /*!
+     * @brief Вывод заполненности очередей и времени простоя стадий потокового режима
+     */
+    void printStreamingStats();
+
+    /// @brief Количество кадров, переданных монитору в потоковом режиме
+    size_t streamedFrames() const { return pipeline.stats()[StreamingPipeline::kDisplay].processed; }
 
-    void setHardwareDecoding(bool value) { hardware_decoding_ = value; };
+    /*!
+     * @brief Воспроизведение записанного сеанса
+     * Кадры сеанса обрабатываются и переводятся пакетами со скоростью чтения диска, без вывода на монитор.
+     * Виды животных, определенные классификатором, сверяются с записанными.
+     * @param[in] path Путь к файлу сеанса
+     */
+    void replay(const std::string& path);
+
+    /*!
+     * @brief Обработка поступивших кадров без ожидания и вывода на монитор
+     * Используется узлом, на котором работает много устройств: узел сам решает, когда и сколько кадров
+     * обрабатывает каждое устройство.
+     * @param[in] budget Максимальное количество кадров
+     * @param[out] animals Количество переведенных животных
+     * @return Количество обработанных кадров
+     */
+    size_t serve(size_t budget, size_t& animals);
+
+    /// @brief Включение или выключение устройства без сообщений
+    void setPower(bool value) { power_ = value; }
+
+    /// @brief Отключение сообщений о ходе обработки
+    void setQuiet(bool value) {
+        quiet_ = value;
+        translator.setQuiet(value);
+    }
+
+    /// @brief Вывод смоделированной длительности обработки на аппаратуре устройства рядом с измеренной
+    void setProjection(bool value) { projection_ = value; }
+
+    /*!
+     * @brief Замена реализации стадии
+     * Замена допустима во время обработки и вступает в силу со следующего кадра.
+     * @param[in] stage Стадия
+     * @param[in] backend Реализация
+     */
+    void setBackend(execution::Stage stage, execution::Backend backend) {
+        if (!quiet_)
+            output::line() << "Стадия " << execution::kStageNames[stage] << " исполняется реализацией "
+                           << execution::kBackendNames[backend];
+        backends_.set(stage, backend);
+    }
+
+    const execution::Backends& backends() const { return backends_; }
+
+    /*!
+     * @brief Выбор языка сообщений устройства
+     * @param[in] name Название языка в текущем каталоге сообщений
+     * @return false, если такого языка в каталоге нет
+     */
+    bool setLocale(std::string_view name);
+
+    /// @brief Название выбранного языка сообщений
+    std::string_view localeName() const;
+
+    /// @brief Включение или выключение кэша прогнозов переводчика
+    void setMemoization(bool value) {
+        if (!quiet_)
+            output::line() << (value ? "Кэш прогнозов включен" : "Кэш прогнозов выключен");
+        translator.setMemoization(value);
+    }
+
+    /// @brief Включение или выключение инкрементального перевода сопровождаемых животных
+    void setIncremental(bool value) {
+        if (!quiet_)
+            output::line() << (value ? "Неизменившиеся животные не переводятся заново"
+                                     : "Все животные переводятся заново в каждом кадре");
+        translator.setIncremental(value);
+    }
+
+    /// @brief Вывод счетчиков сопровождения животных
+    void printTrackingStats();
+
+    /*!
+     * @brief Проверка инкрементального перевода на записанном сеансе
+     * Сеанс воспроизводится дважды: с переводом всех животных заново и с переносом переводов неизменившихся
+     * животных. Выводится количество животных, вид или сообщение которых различаются.
+     * @param[in] path Путь к файлу сеанса
+     */
+    void checkTracking(const std::string& path);
+
+    /// @brief Включение или выключение классификации, специализированной по видам
+    void setSpecialization(bool value) {
+        if (!quiet_)
+            output::line() << (value ? "Виды оцениваются кодом, специализированным по видам"
+                                     : "Виды оцениваются по таблицам признаков");
+        translator.setSpecialization(value);
+    }
+
+    /*!
+     * @brief Замер классификации, специализированной по видам, в сравнении с классификацией по таблицам
+     * @param[in] animal_count Количество животных
+     */
+    void runSpeciesBenchmark(size_t animal_count) { translator.runSpeciesBenchmark(animal_count); }
+
+    /*!
+     * @brief Вывод счетчиков кэша прогнозов
+     * @param[in] reset Очистить кэш и сбросить счетчики после вывода
+     */
+    void printPredictionStats(bool reset);
+
+    void setParallelFormatting(bool value) {
+        if (!quiet_)
+            output::line() << (value ? "Видео и звук обрабатываются одновременно"
+                                     : "Видео и звук обрабатываются по очереди");
+        sensor.setParallelFormatting(value);
+    };
 
 private:
-    bool hardware_video_    = false;
-    bool hardware_audio_    = false;
-    long hardware_classify  = 0;
-    bool hardware_decoding_ = false;
+    /// @brief Реализации стадий обработки (объявлены первыми, так как на них ссылаются обработчики)
+    execution::Backends backends_;
     /// @brief Обработчик внешних сигналов
     Sensor sensor;
     /// @brief Переводчик сообщения
     Translator translator;
     /// @brief Монитор для вывода полученной информации
     Monitor monitor;
-    bool power_ = false;
+    /// @brief Конвейер потокового режима
+    StreamingPipeline pipeline;
+    /// @brief Буферы обработки кадров по запросу узла
+    std::vector<animal::PreparedData> serve_batch;
+    std::vector<std::vector<animal::DecodedAnimalCharacteristic>> serve_decoded;
+    /*!
+     * @brief Проекция длительности обработки на аппаратуру устройства
+     * Модель по количеству тактов стадий и тактовой частоте выбранного исполнения; ничего не измеряет.
+     * @return Смоделированная длительность обработки, с
+     */
+    double project();
+
+    /*!
+     * @brief Перевод кадров записанного сеанса пакетами
+     * @param[in] reader Открытый сеанс
+     * @param[in] visit Обработчик переводов кадра: номер кадра в сеансе и переводы его животных
+     */
+    void replayFrames(
+        const session::SessionReader& reader,
+        const std::function<void(size_t, std::span<const animal::DecodedAnimalCharacteristic>)>& visit);
+
+    bool power_      = false;
+    bool quiet_      = false;
+    bool projection_ = true;
+    /// @brief Количество кадров записанного сеанса, переводимых одним пакетом
+    static constexpr size_t kReplayBatch = 8;
+
     /// @brief Множители тактовой частоты
     static constexpr double kHardFreq = 1.5;
     static constexpr double kSoftFreq = 3.5;
     /// @brief Количество тактов
     static constexpr std::pair<long, long> kHardwareVideoStep    = {35000000000, 300000000};
     static constexpr std::pair<long, long> kHardwareAudioStep    = {3000000000, 30000000};
-    std::vector<long> kHardwareClassifyStep                      = {100000, 300000, 2500000};
-    std::vector<double> kHardwareClassifyFreq                    = {1.4, 1.0, 3.5};
     static constexpr std::pair<long, long> kHardwareDecodingStep = {6500000000, 65000000};
+    /// @brief Такты и множитель частоты классификации для каждой реализации (CPU, NPU, GPU)
+    static constexpr std::array<long, execution::kMaxBackend> kClassifyStep   = {2500000, 300000, 100000};
+    static constexpr std::array<double, execution::kMaxBackend> kClassifyFreq = {3.5, 1.0, 1.4};
 };
 
 }  // namespace translator
@@ -0,0 +1,73 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace memory {
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+void* allocate(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc требует размер, кратный выравниванию
+    const size_t align = static_cast<size_t>(alignment);
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+}  // namespace
+
+size_t allocations() { return allocation_count.load(std::memory_order_relaxed); }
+
+}  // namespace memory
+
+void* operator new(size_t size) {
+    if (void* pointer = memory::allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* pointer = memory::allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return memory::allocate(size); }
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return memory::allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* pointer = memory::allocateAligned(size, alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* pointer = memory::allocateAligned(size, alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
@@ -0,0 +1,258 @@
+#include "animal_classifier.h"
+
+#include "species.h"
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ANIMAL_CLASSIFIER_X86 1
+#endif
+
+namespace translator {
+
+namespace {
+
+/// @brief Оценка одного животного по таблицам признаков видов
+animal::AnimalType classifyOne(const AnimalClassifier::Profile& profile, int32_t size, int32_t volume, float frequency,
+                               uint32_t larynx, uint32_t throat) {
+    int32_t best_score = -1;
+    size_t best_type   = 0;
+    for (size_t type = 0; type < animal::MaxAnimalType; type++) {
+        int32_t score = 0;
+        score += (size >= profile.size_min[type] && size <= profile.size_max[type]) * AnimalClassifier::kRangeWeight;
+        score += (volume >= profile.volume_min[type] && volume <= profile.volume_max[type]) *
+                 AnimalClassifier::kRangeWeight;
+        score += (frequency <= profile.frequency_max[type]) * AnimalClassifier::kRangeWeight;
+        score += ((profile.larynx_mask[type] >> larynx) & 1) * AnimalClassifier::kCategoryWeight;
+        score += ((profile.throat_mask[type] >> throat) & 1) * AnimalClassifier::kCategoryWeight;
+        if (score > best_score) {
+            best_score = score;
+            best_type  = type;
+        }
+    }
+    return static_cast<animal::AnimalType>(best_type);
+}
+
+/// @brief Оценка животного как животного вида Type; признаки вида - константы времени компиляции
+template <animal::AnimalType Type>
+int32_t scoreSpecies(int32_t size, int32_t volume, float frequency, uint32_t larynx, uint32_t throat) {
+    using Traits  = animal::SpeciesTraits<Type>;
+    int32_t score = 0;
+    score += (size >= Traits::kSizeMin && size <= Traits::kSizeMax) * AnimalClassifier::kRangeWeight;
+    score += (volume >= Traits::kVolumeMin && volume <= Traits::kVolumeMax) * AnimalClassifier::kRangeWeight;
+    score += (frequency <= (float)Traits::kFrequencyMax) * AnimalClassifier::kRangeWeight;
+    score += ((Traits::kLarynxMask >> larynx) & 1) * AnimalClassifier::kCategoryWeight;
+    score += ((Traits::kThroatMask >> throat) & 1) * AnimalClassifier::kCategoryWeight;
+    return score;
+}
+
+/// @brief Оценка одного животного; общая часть для скалярного пути и хвостов SIMD-путей. Цикл по видам развернут
+animal::AnimalType classifySpecies(int32_t size, int32_t volume, float frequency, uint32_t larynx, uint32_t throat) {
+    int32_t best_score           = -1;
+    animal::AnimalType best_type = animal::Cat;
+    animal::forEachSpecies([&](auto species) {
+        const int32_t score = scoreSpecies<decltype(species)::value>(size, volume, frequency, larynx, throat);
+        if (score > best_score) {
+            best_score = score;
+            best_type  = decltype(species)::value;
+        }
+    });
+    return best_type;
+}
+
+void classifyScalar(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                    std::span<animal::AnimalType> types, size_t begin, size_t end) {
+    for (size_t iter = begin; iter < end; iter++) {
+        types[iter] = classifySpecies(pantomime.size[iter], sound.volume[iter], sound.frequency[iter],
+                                      sound.larinx[iter], sound.throat[iter]);
+    }
+}
+
+void classifyGeneric(const AnimalClassifier::Profile& profile, const pantomime::PantomimeBatch& pantomime,
+                     const syllable::SoundBatch& sound, std::span<animal::AnimalType> types, size_t begin,
+                     size_t end) {
+    for (size_t iter = begin; iter < end; iter++) {
+        types[iter] = classifyOne(profile, pantomime.size[iter], sound.volume[iter], sound.frequency[iter],
+                                  sound.larinx[iter], sound.throat[iter]);
+    }
+}
+
+#ifdef ANIMAL_CLASSIFIER_X86
+
+__attribute__((target("avx2"))) void classifyAvx2(const AnimalClassifier::Profile& profile,
+                                                   const pantomime::PantomimeBatch& pantomime,
+                                                   const syllable::SoundBatch& sound,
+                                                   std::span<animal::AnimalType> types, size_t begin, size_t end) {
+    constexpr size_t kLanes = 8;
+    const __m256i one       = _mm256_set1_epi32(1);
+    size_t iter             = begin;
+    for (; iter + kLanes <= end; iter += kLanes) {
+        const __m256i size = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pantomime.size.data() + iter));
+        const __m256i volume =
+            _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sound.volume.data() + iter)));
+        const __m256 frequency = _mm256_loadu_ps(sound.frequency.data() + iter);
+        const __m256i larynx_bit = _mm256_sllv_epi32(
+            one, _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sound.larinx.data() + iter))));
+        const __m256i throat_bit = _mm256_sllv_epi32(
+            one, _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sound.throat.data() + iter))));
+
+        __m256i best_score = _mm256_set1_epi32(-1);
+        __m256i best_type  = _mm256_setzero_si256();
+        for (size_t type = 0; type < animal::MaxAnimalType; type++) {
+            // Маски сравнения равны -1 в совпавших дорожках, поэтому вычитание маски добавляет единицу к оценке
+            const __m256i in_size =
+                _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(profile.size_min[type]), size),
+                                    _mm256_cmpgt_epi32(_mm256_set1_epi32(profile.size_max[type] + 1), size));
+            const __m256i in_volume =
+                _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(profile.volume_min[type]), volume),
+                                    _mm256_cmpgt_epi32(_mm256_set1_epi32(profile.volume_max[type] + 1), volume));
+            const __m256i in_frequency = _mm256_castps_si256(
+                _mm256_cmp_ps(frequency, _mm256_set1_ps(profile.frequency_max[type]), _CMP_LE_OQ));
+            const __m256i in_larynx = _mm256_cmpgt_epi32(
+                _mm256_and_si256(larynx_bit, _mm256_set1_epi32(profile.larynx_mask[type])), _mm256_setzero_si256());
+            const __m256i in_throat = _mm256_cmpgt_epi32(
+                _mm256_and_si256(throat_bit, _mm256_set1_epi32(profile.throat_mask[type])), _mm256_setzero_si256());
+
+            __m256i ranges   = _mm256_add_epi32(_mm256_add_epi32(in_size, in_volume), in_frequency);
+            __m256i category = _mm256_add_epi32(in_larynx, in_throat);
+            __m256i score    = _mm256_sub_epi32(
+                _mm256_setzero_si256(),
+                _mm256_add_epi32(_mm256_mullo_epi32(ranges, _mm256_set1_epi32(AnimalClassifier::kRangeWeight)),
+                                 _mm256_mullo_epi32(category, _mm256_set1_epi32(AnimalClassifier::kCategoryWeight))));
+
+            const __m256i better = _mm256_cmpgt_epi32(score, best_score);
+            best_score           = _mm256_blendv_epi8(best_score, score, better);
+            best_type            = _mm256_blendv_epi8(best_type, _mm256_set1_epi32(type), better);
+        }
+        alignas(32) int32_t result[kLanes];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result), best_type);
+        for (size_t lane = 0; lane < kLanes; lane++) types[iter + lane] = static_cast<animal::AnimalType>(result[lane]);
+    }
+    classifyScalar(pantomime, sound, types, iter, end);
+}
+
+__attribute__((target("sse4.1"))) __m128i maskMembership(__m128i value, uint32_t mask) {
+    // Без переменных сдвигов SSE принадлежность множеству проверяется сравнением с каждым его элементом
+    __m128i member = _mm_setzero_si128();
+    for (int32_t bit = 0; mask >> bit; bit++) {
+        if ((mask >> bit) & 1)
+            member = _mm_or_si128(member, _mm_cmpeq_epi32(value, _mm_set1_epi32(bit)));
+    }
+    return member;
+}
+
+__attribute__((target("sse4.1"))) void classifySse41(const AnimalClassifier::Profile& profile,
+                                                     const pantomime::PantomimeBatch& pantomime,
+                                                     const syllable::SoundBatch& sound,
+                                                     std::span<animal::AnimalType> types, size_t begin,
+                                                     size_t end) {
+    constexpr size_t kLanes = 4;
+    size_t iter             = begin;
+    for (; iter + kLanes <= end; iter += kLanes) {
+        const __m128i size = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pantomime.size.data() + iter));
+        const __m128i volume =
+            _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sound.volume.data() + iter)));
+        const __m128 frequency = _mm_loadu_ps(sound.frequency.data() + iter);
+        int32_t larynx_packed, throat_packed;
+        std::copy_n(sound.larinx.data() + iter, kLanes, reinterpret_cast<uint8_t*>(&larynx_packed));
+        std::copy_n(sound.throat.data() + iter, kLanes, reinterpret_cast<uint8_t*>(&throat_packed));
+        const __m128i larynx = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(larynx_packed));
+        const __m128i throat = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(throat_packed));
+
+        __m128i best_score = _mm_set1_epi32(-1);
+        __m128i best_type  = _mm_setzero_si128();
+        for (size_t type = 0; type < animal::MaxAnimalType; type++) {
+            const __m128i in_size   = _mm_andnot_si128(_mm_cmpgt_epi32(_mm_set1_epi32(profile.size_min[type]), size),
+                                                       _mm_cmpgt_epi32(_mm_set1_epi32(profile.size_max[type] + 1), size));
+            const __m128i in_volume =
+                _mm_andnot_si128(_mm_cmpgt_epi32(_mm_set1_epi32(profile.volume_min[type]), volume),
+                                 _mm_cmpgt_epi32(_mm_set1_epi32(profile.volume_max[type] + 1), volume));
+            const __m128i in_frequency =
+                _mm_castps_si128(_mm_cmple_ps(frequency, _mm_set1_ps(profile.frequency_max[type])));
+            const __m128i in_larynx = maskMembership(larynx, profile.larynx_mask[type]);
+            const __m128i in_throat = maskMembership(throat, profile.throat_mask[type]);
+
+            __m128i ranges   = _mm_add_epi32(_mm_add_epi32(in_size, in_volume), in_frequency);
+            __m128i category = _mm_add_epi32(in_larynx, in_throat);
+            __m128i score =
+                _mm_sub_epi32(_mm_setzero_si128(),
+                              _mm_add_epi32(_mm_mullo_epi32(ranges, _mm_set1_epi32(AnimalClassifier::kRangeWeight)),
+                                            _mm_mullo_epi32(category, _mm_set1_epi32(AnimalClassifier::kCategoryWeight))));
+
+            const __m128i better = _mm_cmpgt_epi32(score, best_score);
+            best_score           = _mm_blendv_epi8(best_score, score, better);
+            best_type            = _mm_blendv_epi8(best_type, _mm_set1_epi32(type), better);
+        }
+        alignas(16) int32_t result[kLanes];
+        _mm_store_si128(reinterpret_cast<__m128i*>(result), best_type);
+        for (size_t lane = 0; lane < kLanes; lane++) types[iter + lane] = static_cast<animal::AnimalType>(result[lane]);
+    }
+    classifyScalar(pantomime, sound, types, iter, end);
+}
+
+#endif
+
+}  // namespace
+
+AnimalClassifier::AnimalClassifier() : isa_(detectIsa()), detected_(isa_) {
+    for (size_t iter = 0; iter < animal::MaxAnimalType; iter++) {
+        const auto type               = static_cast<animal::AnimalType>(iter);
+        profile_.size_min[iter]       = animal::animal_sizes[type].first;
+        profile_.size_max[iter]       = animal::animal_sizes[type].second;
+        profile_.volume_min[iter]     = animal::animal_volume[type].first;
+        profile_.volume_max[iter]     = animal::animal_volume[type].second;
+        profile_.frequency_max[iter]  = animal::animal_frequency[type];
+        profile_.larynx_mask[iter]    = 0;
+        profile_.throat_mask[iter]    = 0;
+        for (auto larynx : animal::animal_larynx[type]) profile_.larynx_mask[iter] |= 1u << larynx;
+        for (auto throat : animal::animal_throat[type]) profile_.throat_mask[iter] |= 1u << throat;
+    }
+}
+
+AnimalClassifier::Isa AnimalClassifier::detectIsa() {
+#ifdef ANIMAL_CLASSIFIER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return kAvx2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return kSse41;
+#endif
+    return kScalar;
+}
+
+AnimalClassifier::Isa AnimalClassifier::setIsa(Isa isa) {
+    isa_ = std::min(isa, detected_);
+    return isa_;
+}
+
+void AnimalClassifier::classify(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                                std::span<animal::AnimalType> types) const {
+    classify(pantomime, sound, types, isa_, 0, pantomime.count());
+}
+
+void AnimalClassifier::classify(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                                std::span<animal::AnimalType> types, Isa isa, size_t begin, size_t end,
+                                bool specialized) const {
+    switch (std::min(isa, detected_)) {
+#ifdef ANIMAL_CLASSIFIER_X86
+        case kAvx2:
+            classifyAvx2(profile_, pantomime, sound, types, begin, end);
+            return;
+        case kSse41:
+            classifySse41(profile_, pantomime, sound, types, begin, end);
+            return;
+#endif
+        default:
+            if (specialized)
+                classifyScalar(pantomime, sound, types, begin, end);
+            else
+                classifyGeneric(profile_, pantomime, sound, types, begin, end);
+            return;
+    }
+}
+
+animal::AnimalType AnimalClassifier::classify(const pantomime::Pantomime& pantomime,
+                                              const syllable::Sound& sound) const {
+    return classifySpecies(pantomime.size, sound.volume, sound.frequency, sound.larinx, sound.throat);
+}
+
+}  // namespace translator
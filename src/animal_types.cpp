@@ -1,69 +1,111 @@
 #include "animal_types.h"
 
-namespace animal {
-
-std::map<AnimalType, std::pair<long, long>> animal_sizes{
-    {AnimalType::Cat, {45, 60}},   {AnimalType::Dog, {22, 140}},   {AnimalType::Parrot, {15, 40}},
-    {AnimalType::Cow, {150, 270}}, {AnimalType::Sheep, {60, 110}},
-};
-
-std::map<AnimalType, double> animal_frequency{
-    {AnimalType::Cat, 20000}, {AnimalType::Dog, 1500},   {AnimalType::Parrot, 20000},
-    {AnimalType::Cow, 35000}, {AnimalType::Sheep, 1000},
-};
-
-std::map<AnimalType, std::pair<int, int>> animal_volume{
-    {AnimalType::Cat, {20, 85}},  {AnimalType::Dog, {60, 120}},   {AnimalType::Parrot, {40, 135}},
-    {AnimalType::Cow, {70, 105}}, {AnimalType::Sheep, {70, 110}},
-};
+#include "prng.h"
+#include "species.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
 
-std::map<AnimalType, std::vector<syllable::ThroatSound>> animal_throat{
-    {AnimalType::Cat, {syllable::ThroatSound::None, syllable::ThroatSound::Meow}},
-    {AnimalType::Dog, {syllable::ThroatSound::None, syllable::ThroatSound::Woof}},
-    {AnimalType::Parrot, {syllable::ThroatSound::None, syllable::ThroatSound::Tweeting}},
-    {AnimalType::Cow, {syllable::ThroatSound::None, syllable::ThroatSound::Moo}},
-    {AnimalType::Sheep, {syllable::ThroatSound::None, syllable::ThroatSound::Bleat}},
-};
-
-std::map<AnimalType, std::vector<syllable::LarynxSound>> animal_larynx{
-    {AnimalType::Cat, {syllable::LarynxSound::Purring, syllable::LarynxSound::Hiss, syllable::LarynxSound::Growl}},
-    {AnimalType::Dog, {syllable::LarynxSound::Growl}},
-    {AnimalType::Parrot, {syllable::LarynxSound::Chirp}},
-    {AnimalType::Cow, {syllable::LarynxSound::Mooing}},
-    {AnimalType::Sheep, {syllable::LarynxSound::Bleating}},
-};
+namespace animal {
 
 namespace random {
 
 static constexpr double kMaxSoundDuration = 3.0;
 
-static pantomime::Pantomime generatePantomime(AnimalType animal) {
+template <AnimalType Type>
+static pantomime::Pantomime generatePantomime() {
+    using Traits = SpeciesTraits<Type>;
     pantomime::Pantomime pantomime;
-    pantomime.body     = static_cast<pantomime::BodyPosition>(std::rand() % pantomime::MaxBodyPosition);
-    pantomime.facial   = static_cast<pantomime::FacialExpression>(std::rand() % pantomime::MaxFacialExpression);
-    pantomime.gestures = static_cast<pantomime::Gesture>(std::rand() % pantomime::MaxGestures);
-    std::pair<long, long> sizes = animal_sizes[animal];
-    pantomime.size              = std::rand() % (sizes.second - sizes.first) + sizes.first;
+    prng::Xoshiro256& generator = prng::local();
+
+    pantomime.body     = static_cast<pantomime::BodyPosition>(generator.below(pantomime::MaxBodyPosition));
+    pantomime.facial   = static_cast<pantomime::FacialExpression>(generator.below(pantomime::MaxFacialExpression));
+    pantomime.gestures = static_cast<pantomime::Gesture>(generator.below(pantomime::MaxGestures));
+    pantomime.size     = generator.between(Traits::kSizeMin, Traits::kSizeMax);
     return pantomime;
 }
 
-static syllable::Sound generateSound(AnimalType animal) {
+template <AnimalType Type>
+static syllable::Sound generateSound() {
+    using Traits = SpeciesTraits<Type>;
     syllable::Sound sound;
-    sound.larinx                = animal_larynx[animal][std::rand() % animal_larynx[animal].size()];
-    sound.throat                = animal_throat[animal][std::rand() % animal_throat[animal].size()];
-    sound.duration              = ((double)std::rand()) / RAND_MAX * kMaxSoundDuration;
-    sound.frequency             = ((double)std::rand()) / RAND_MAX * animal_frequency[animal];
-    std::pair<int, int> volumes = animal_volume[animal];
-    sound.volume                = std::rand() % (volumes.second - volumes.first) + volumes.first;
+    prng::Xoshiro256& generator = prng::local();
+    sound.larinx                = Traits::kLarynx[generator.below(Traits::kLarynx.size())];
+    sound.throat                = Traits::kThroat[generator.below(Traits::kThroat.size())];
+    sound.duration              = generator.real() * kMaxSoundDuration;
+    sound.frequency             = generator.real() * Traits::kFrequencyMax;
+    sound.volume                = generator.between(Traits::kVolumeMin, Traits::kVolumeMax);
     return sound;
 }
 
 DecodedAnimalCharacteristic generateAnimal() {
-    const AnimalType animal_type               = static_cast<AnimalType>(std::rand() % MaxAnimalType);
-    DecodedAnimalCharacteristic decoded_animal = {.animal_type = animal_type};
-    AnimalCharacteristic animal = {.body = generatePantomime(animal_type), .sound = generateSound(animal_type)};
-    decoded_animal.animal       = animal;
-    return decoded_animal;
+    const AnimalType animal_type = static_cast<AnimalType>(prng::local().below(MaxAnimalType));
+    // Вид выбирается один раз, признаки генерируются кодом, специализированным по виду
+    return dispatchSpecies(animal_type, [](auto species) {
+        constexpr AnimalType kType = decltype(species)::value;
+        return (DecodedAnimalCharacteristic){
+            .animal_type = kType,
+            .animal      = {.body = generatePantomime<kType>(), .sound = generateSound<kType>()}};
+    });
+}
+
+double renderVideo(pantomime::Video& video, unsigned width, unsigned height) {
+    static constexpr double kMinDepth         = 4;   ///< Минимальное расстояние до фигуры, м
+    static constexpr double kMaxDepth         = 10;  ///< Максимальное расстояние до фигуры, м
+    static constexpr int kMaxCalibrationError = 8;   ///< Максимальная ошибка калибровки диспаритета
+    video.width  = width;
+    video.height = height;
+    video.disparity.assign((size_t)width * height, 0);
+    if (video.figures.empty())
+        return 0;
+    prng::Xoshiro256& generator = prng::local();
+    const int calibration_error = generator.between(-kMaxCalibrationError, kMaxCalibrationError + 1);
+    const unsigned column       = width / video.figures.size();
+    double distance             = 0;
+    for (size_t iter = 0; iter < video.figures.size(); iter++) {
+        const double depth = generator.uniform(kMinDepth, kMaxDepth);
+        const auto value   = (uint8_t)std::clamp<long>(
+            std::lround(pantomime::kFocalLength * pantomime::kStereoBaseline / depth) + calibration_error, 1, 255);
+        // Фигура - эллипс, вписанный в собственный столбец кадра
+        const double half_height = std::min<double>(video.figures[iter].size / 100.0 * pantomime::kFocalLength / depth,
+                                                    height - 2) / 2;
+        const double half_width  = std::min(half_height * 0.8, column * 0.4);
+        const double center_x    = column * (iter + 0.5);
+        const double center_y    = height / 2.0;
+        const auto top           = (unsigned)std::ceil(center_y - half_height);
+        const auto bottom        = (unsigned)std::floor(center_y + half_height);
+        for (unsigned y = top; y <= bottom; y++) {
+            const double dy   = (y - center_y) / half_height;
+            const double span = half_width * std::sqrt(std::max(0.0, 1 - dy * dy));
+            const auto left   = (unsigned)std::max(0.0, std::ceil(center_x - span));
+            const auto right  = (unsigned)std::min(width - 1.0, std::floor(center_x + span));
+            if (left <= right)
+                std::fill_n(video.disparity.begin() + (size_t)y * width + left, right - left + 1, value);
+        }
+        // Дальномер направлен в центр кадра и измеряет расстояние до попавшей в него фигуры
+        if (std::abs(width / 2.0 - center_x) <= half_width)
+            distance = depth;
+    }
+    return distance;
+}
+
+size_t noiseLength(const syllable::Noise& noise, unsigned sample_rate) {
+    double length = 0;
+    for (const auto& sound : noise.noises) length = std::max(length, sound.duration);
+    return (size_t)(length * sample_rate);
+}
+
+void renderNoise(const syllable::Noise& noise, unsigned sample_rate, size_t offset, std::span<float> samples) {
+    std::fill(samples.begin(), samples.end(), 0.0f);
+    for (const auto& sound : noise.noises) {
+        const size_t count = (size_t)(sound.duration * sample_rate);
+        if (count <= offset)
+            continue;
+        const double amplitude = std::pow(10.0, (sound.volume - syllable::kFullScaleVolume) / 20);
+        const double step      = 2 * std::numbers::pi * sound.frequency / sample_rate;
+        const size_t end       = std::min(samples.size(), count - offset);
+        for (size_t iter = 0; iter < end; iter++) samples[iter] += amplitude * std::sin(step * (offset + iter));
+    }
 }
 
 }  // namespace random
@@ -0,0 +1,539 @@
+#include "benchmark.h"
+
+#include "allocation_counter.h"
+#include "animal_classifier.h"
+#include "animal_types.h"
+#include "blocking_queue.h"
+#include "depth_map.h"
+#include "frame_bus.h"
+#include "output.h"
+#include "prng.h"
+#include "readiness_event.h"
+#include "spectrum.h"
+#include "task_pool.h"
+#include "translator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <sys/resource.h>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief Процессорное время всех потоков процесса с момента запуска, с
+static double cpuTime() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+/*!
+ * @brief Значение заданного уровня из выборки
+ * @param[in,out] samples Выборка (упорядочивается)
+ * @param[in] level Уровень от 0 до 1
+ */
+static double percentile(std::vector<double>& samples, double level) {
+    if (samples.empty())
+        return 0;
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(level * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void runCommandQueue(size_t commands) {
+    // Длительность простоя диспетчера, с
+    static constexpr double kIdleSeconds = 1;
+    // Пауза между командами, чтобы каждая команда заставала диспетчер ожидающим
+    static constexpr auto kPause = std::chrono::microseconds(100);
+
+    // Команда замера: момент постановки в очередь; команда с признаком stop останавливает диспетчер
+    struct Command {
+        Clock::time_point sent;
+        bool stop = false;
+    };
+    for (bool spinning : {false, true}) {
+        concurrency::BlockingQueue<Command> queue;
+        std::vector<double> delays;
+        delays.reserve(commands);
+        std::thread dispatcher([&queue, &delays, spinning] {
+            while (true) {
+                Command command;
+                if (spinning) {
+                    std::optional<Command> polled = queue.tryPop();
+                    if (!polled)
+                        continue;
+                    command = *polled;
+                } else {
+                    command = queue.pop();
+                }
+                if (command.stop)
+                    return;
+                delays.push_back(std::chrono::duration<double, std::micro>(Clock::now() - command.sent).count());
+            }
+        });
+        const double cpu_start = cpuTime();
+        const auto idle_start  = Clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(kIdleSeconds));
+        const double cpu                         = cpuTime() - cpu_start;
+        const std::chrono::duration<double> idle = Clock::now() - idle_start;
+        for (size_t iter = 0; iter < commands; iter++) {
+            queue.push({Clock::now()});
+            std::this_thread::sleep_for(kPause);
+        }
+        queue.push({Clock::now(), true});
+        dispatcher.join();
+        const double p50 = percentile(delays, 0.5);
+        const double p99 = percentile(delays, 0.99);
+        output::line() << (spinning ? "Опрос очереди в цикле" : "Блокирующая очередь") << ": простой "
+                       << 100 * cpu / idle.count() << "% ядра, задержка команды p50 " << p50 << " мкс, p99 " << p99
+                       << " мкс";
+    }
+}
+
+void runFrameRing(size_t frames) {
+    static constexpr size_t kCapacity = 64;
+    // Количество кадров замера задержки и пауза между ними, чтобы читатель успевал заснуть
+    static constexpr size_t kLatencyFrames = 10000;
+    static constexpr auto kPause           = std::chrono::microseconds(100);
+
+    // Передача кадров: писатель пишет кадры по порядку, читатель проверяет порядок и считает полученные кадры
+    auto measure = [frames](auto&& push, auto&& pop) {
+        const auto start = Clock::now();
+        std::atomic<bool> writing{true};
+        std::thread writer([&push, &writing, frames] {
+            for (size_t iter = 0; iter < frames; iter++) {
+                animal::Frame frame;
+                frame.distance = iter;
+                push(std::move(frame));
+            }
+            writing.store(false, std::memory_order_release);
+        });
+        size_t received = 0, reordered = 0;
+        double last     = -1;
+        animal::Frame frame;
+        while (true) {
+            // Признак окончания читается до попытки чтения, поэтому пустой буфер после окончания записи - конец
+            const bool written = !writing.load(std::memory_order_acquire);
+            if (pop(frame)) {
+                reordered += frame.distance <= last;
+                last = frame.distance;
+                received++;
+            } else if (written) {
+                break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        writer.join();
+        const std::chrono::duration<double> time = Clock::now() - start;
+        return std::tuple{frames / time.count(), received, reordered};
+    };
+    auto report = [frames](std::string_view name, std::tuple<double, size_t, size_t> result, size_t lost) {
+        const auto [rate, received, reordered] = result;
+        output::line() << name << ": " << rate << " кадров/с, получено " << received << " из " << frames
+                       << ", потеряно " << lost << ", нарушений порядка " << reordered;
+    };
+
+    {
+        // Прежняя передача: видео, звук и типы в отдельных очередях, каждый кадр выделяет узлы очередей
+        std::mutex mu;
+        std::deque<pantomime::Video> video;
+        std::deque<syllable::Noise> noise;
+        std::deque<animal::AnimalDecodingStub> types;
+        const auto result = measure(
+            [&](animal::Frame frame) {
+                std::lock_guard lock(mu);
+                video.push_back(std::move(frame.video));
+                noise.push_back(std::move(frame.noise));
+                types.push_back(std::move(frame.types));
+                video.back().width = frame.distance;
+            },
+            [&](animal::Frame& frame) {
+                std::lock_guard lock(mu);
+                if (video.empty())
+                    return false;
+                frame.distance = video.front().width;
+                frame.video    = std::move(video.front());
+                frame.noise    = std::move(noise.front());
+                frame.types    = std::move(types.front());
+                video.pop_front();
+                noise.pop_front();
+                types.pop_front();
+                return true;
+            });
+        report("Три очереди под блокировкой", result, 0);
+    }
+    static constexpr std::pair<concurrency::OverflowPolicy, std::string_view> kPolicies[] = {
+        {concurrency::OverflowPolicy::kBlock, "Кольцо, ожидание места"},
+        {concurrency::OverflowPolicy::kDropOldest, "Кольцо, вытеснение старых"},
+        {concurrency::OverflowPolicy::kReject, "Кольцо, отказ в записи"},
+    };
+    for (const auto& [policy, name] : kPolicies) {
+        animal::FrameRing ring(kCapacity, policy);
+        const auto result = measure([&ring](animal::Frame frame) { ring.push(std::move(frame)); },
+                                    [&ring](animal::Frame& frame) { return ring.tryPop(frame); });
+        report(name, result, ring.dropped() + ring.rejected());
+    }
+
+    // Задержка от публикации кадра до пробуждения читателя, ждущего на событии готовности
+    animal::FrameRing ring(kCapacity);
+    concurrency::ReadinessEvent ready;
+    std::vector<Clock::time_point> sent(kLatencyFrames);
+    std::vector<double> delays;
+    delays.reserve(kLatencyFrames);
+    std::thread reader([&ring, &ready, &sent, &delays] {
+        animal::Frame frame;
+        while (delays.size() < kLatencyFrames) {
+            if (!ring.tryPop(frame)) {
+                ready.waitFor(std::chrono::milliseconds(100));
+                continue;
+            }
+            delays.push_back(
+                std::chrono::duration<double, std::micro>(Clock::now() - sent[(size_t)frame.distance]).count());
+        }
+    });
+    for (size_t iter = 0; iter < kLatencyFrames; iter++) {
+        animal::Frame frame;
+        frame.distance = iter;
+        sent[iter]     = Clock::now();
+        ring.push(std::move(frame));
+        ready.notify();
+        std::this_thread::sleep_for(kPause);
+    }
+    reader.join();
+    const double p50 = percentile(delays, 0.5);
+    const double p99 = percentile(delays, 0.99);
+    output::line() << "Пробуждение читателя событием готовности: задержка кадра p50 " << p50 << " мкс, p99 " << p99
+                   << " мкс";
+}
+
+void runTaskPool(size_t frames) {
+    static constexpr size_t kAnimalCounts[] = {1, 3, 8, 16, 32, 64, 128};
+    std::vector<size_t> thread_counts = {1, 2, 4, 8};
+    thread_counts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+
+    // Одинаковые кадры для всех сочетаний
+    prng::seed(1);
+    std::vector<animal::PreparedData> prepared;
+    for (size_t animal_count : kAnimalCounts) {
+        animal::PreparedData data{.ready = true};
+        for (size_t iter = 0; iter < animal_count; iter++) {
+            const animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
+            data.pantomime.push_back(animal.animal.body);
+            data.sound.push_back(animal.animal.sound);
+            data.types.push_back(animal.animal_type);
+        }
+        prepared.push_back(std::move(data));
+    }
+    for (size_t threads : thread_counts) {
+        concurrency::TaskPool pool(threads);
+        execution::Backends backends;
+        translator::Translator translator(pool, backends);
+        translator.setQuiet(true);
+        translator.setIncremental(false);
+        translator.setMemoization(false);
+        output::Line line(output::sink());
+        line << "Потоков " << threads << ", кадров/с по животным в кадре";
+        for (animal::PreparedData& data : prepared) {
+            translator.translate(data);
+            const auto start = Clock::now();
+            for (size_t iter = 0; iter < frames; iter++) translator.translate(data);
+            const std::chrono::duration<double> time = Clock::now() - start;
+            line << (&data == &prepared.front() ? ": " : ", ") << data.pantomime.size() << " - "
+                 << frames / time.count();
+        }
+    }
+}
+
+void runClassifier(size_t animals) {
+    static constexpr size_t kRepeats = 20;
+    using translator::AnimalClassifier;
+    prng::seed(1);
+    std::vector<pantomime::Pantomime> figures(animals);
+    std::vector<syllable::Sound> sounds(animals);
+    pantomime::PantomimeBatch pantomime;
+    syllable::SoundBatch sound;
+    for (size_t iter = 0; iter < animals; iter++) {
+        const animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
+        figures[iter]                                    = animal.animal.body;
+        sounds[iter]                                     = animal.animal.sound;
+        pantomime.push_back(figures[iter]);
+        sound.push_back(sounds[iter]);
+    }
+    const AnimalClassifier classifier;
+    const double count = (double)animals * kRepeats;
+    output::line() << "Замер классификатора: животных " << animals << ", повторов " << kRepeats;
+
+    // Поштучная классификация, как до появления пакетного классификатора; ее результаты - образец
+    std::vector<animal::AnimalType> expected(animals), types(animals);
+    auto start = Clock::now();
+    for (size_t repeat = 0; repeat < kRepeats; repeat++) {
+        for (size_t iter = 0; iter < animals; iter++) expected[iter] = classifier.classify(figures[iter], sounds[iter]);
+    }
+    std::chrono::duration<double> time = Clock::now() - start;
+    output::line() << "\tпо одному животному: " << count / time.count() << " классификаций/с";
+    for (size_t isa = 0; isa <= classifier.bestIsa(); isa++) {
+        for (bool specialized : {false, true}) {
+            // Развертка по видам есть только у скалярной классификации
+            if (isa != AnimalClassifier::kScalar && !specialized)
+                continue;
+            start = Clock::now();
+            for (size_t repeat = 0; repeat < kRepeats; repeat++) {
+                classifier.classify(pantomime, sound, types, static_cast<AnimalClassifier::Isa>(isa), 0, animals,
+                                    specialized);
+            }
+            time                    = Clock::now() - start;
+            const size_t mismatches = animals - std::inner_product(types.begin(), types.end(), expected.begin(),
+                                                                   size_t(0), std::plus<>(), std::equal_to<>());
+            output::line() << "\tпакет, " << AnimalClassifier::kIsaNames[isa]
+                           << (isa == AnimalClassifier::kScalar ? (specialized ? " по видам" : " по таблицам") : "")
+                           << ": " << count / time.count() << " классификаций/с, расхождений " << mismatches;
+        }
+    }
+}
+
+void runTraitTables(size_t animals) {
+    // Наибольшая длительность звука, как при генерации по constexpr-таблицам
+    static constexpr double kMaxSoundDuration = 3.0;
+    // Таблицы признаков в std::map с теми же значениями, что и constexpr-таблицы
+    std::map<animal::AnimalType, std::pair<long, long>> sizes;
+    std::map<animal::AnimalType, double> frequency;
+    std::map<animal::AnimalType, std::pair<int, int>> volume;
+    std::map<animal::AnimalType, std::vector<syllable::ThroatSound>> throat;
+    std::map<animal::AnimalType, std::vector<syllable::LarynxSound>> larynx;
+    for (size_t type = 0; type < animal::MaxAnimalType; type++) {
+        sizes[static_cast<animal::AnimalType>(type)]     = animal::animal_sizes[type];
+        frequency[static_cast<animal::AnimalType>(type)] = animal::animal_frequency[type];
+        volume[static_cast<animal::AnimalType>(type)]    = animal::animal_volume[type];
+        throat[static_cast<animal::AnimalType>(type)].assign(animal::animal_throat[type].begin(),
+                                                             animal::animal_throat[type].end());
+        larynx[static_cast<animal::AnimalType>(type)].assign(animal::animal_larynx[type].begin(),
+                                                             animal::animal_larynx[type].end());
+    }
+    // Генерация животного по таблицам в std::map тем же генератором случайных чисел
+    auto generateFromMaps = [&]() {
+        prng::Xoshiro256& generator = prng::local();
+        const auto type             = static_cast<animal::AnimalType>(generator.below(animal::MaxAnimalType));
+        animal::DecodedAnimalCharacteristic decoded{.animal_type = type};
+        auto& figure    = decoded.animal.body;
+        figure.body     = static_cast<pantomime::BodyPosition>(generator.below(pantomime::MaxBodyPosition));
+        figure.facial   = static_cast<pantomime::FacialExpression>(generator.below(pantomime::MaxFacialExpression));
+        figure.gestures = static_cast<pantomime::Gesture>(generator.below(pantomime::MaxGestures));
+        figure.size     = generator.between(sizes[type].first, sizes[type].second);
+        auto& sound     = decoded.animal.sound;
+        sound.larinx    = larynx[type][generator.below(larynx[type].size())];
+        sound.throat    = throat[type][generator.below(throat[type].size())];
+        sound.duration  = generator.real() * kMaxSoundDuration;
+        sound.frequency = generator.real() * frequency[type];
+        sound.volume    = generator.between(volume[type].first, volume[type].second);
+        return decoded;
+    };
+    // Контрольная сумма не дает компилятору выбросить сгенерированных животных
+    auto measure = [animals](auto&& generate) {
+        prng::seed(1);
+        long checksum    = 0;
+        const auto start = Clock::now();
+        for (size_t iter = 0; iter < animals; iter++) {
+            const animal::DecodedAnimalCharacteristic animal = generate();
+            checksum += animal.animal_type + animal.animal.body.size + animal.animal.sound.volume;
+        }
+        const std::chrono::duration<double> time = Clock::now() - start;
+        return std::pair{animals / time.count(), checksum};
+    };
+    const auto [map_rate, map_checksum]     = measure(generateFromMaps);
+    const auto [table_rate, table_checksum] = measure(animal::random::generateAnimal);
+    output::line() << "Генерация животных: std::map " << map_rate << " животных/с, массивы " << table_rate
+                   << " животных/с, ускорение " << table_rate / map_rate
+                   << (map_checksum == table_checksum ? "" : ", результаты различаются");
+
+    // Названия животных на мониторе
+    static constexpr auto kNames =
+        animal::makeAnimalTable<std::string_view>("котика", "собачку", "попугайчика", "корову", "овечку");
+    std::map<animal::AnimalType, std::string> names;
+    for (size_t type = 0; type < animal::MaxAnimalType; type++)
+        names[static_cast<animal::AnimalType>(type)] = kNames[type];
+    std::vector<animal::AnimalType> types(animals);
+    prng::seed(1);
+    for (auto& type : types) type = static_cast<animal::AnimalType>(prng::local().below(animal::MaxAnimalType));
+    std::string screen;
+    screen.reserve(64);
+    auto display = [&types, &screen](auto&& name) {
+        size_t length    = 0;
+        const auto start = Clock::now();
+        for (animal::AnimalType type : types) {
+            screen.assign("Мы видим здесь ");
+            screen.append(name(type));
+            length += screen.size();
+        }
+        const std::chrono::duration<double> time = Clock::now() - start;
+        return std::pair{types.size() / time.count(), length};
+    };
+    const auto [map_names, map_length] = display([&names](animal::AnimalType type) -> std::string_view {
+        return names[type];
+    });
+    const auto [table_names, table_length] = display([](animal::AnimalType type) { return kNames[type]; });
+    output::line() << "Названия на мониторе: std::map " << map_names << " названий/с, массив " << table_names
+                   << " названий/с, ускорение " << table_names / map_names
+                   << (map_length == table_length ? "" : ", результаты различаются");
+}
+
+void runSpectrum(concurrency::TaskPool& pool, double seconds) {
+    static constexpr unsigned kSampleRates[] = {48000, 96000};
+    static constexpr size_t kAnimals         = 3;
+    prng::seed(1);
+    syllable::Noise noise;
+    for (size_t iter = 0; iter < kAnimals; iter++) {
+        syllable::Sound sound = animal::random::generateAnimal().animal.sound;
+        // Животные звучат всю запись, чтобы каждый кадр анализа содержал несущие
+        sound.duration = seconds;
+        noise.noises.push_back(sound);
+    }
+    std::vector<float> samples;
+    std::vector<syllable::Sound> carriers;
+    for (unsigned sample_rate : kSampleRates) {
+        samples.resize((size_t)(seconds * sample_rate));
+        animal::random::renderNoise(noise, sample_rate, 0, samples);
+        output::line() << "Замер анализа звука: " << sample_rate << " Гц, " << seconds << " с, отсчетов "
+                       << samples.size();
+        for (size_t backend = 0; backend < execution::kMaxBackend; backend++) {
+            if (backend == execution::kSimd && !execution::hasAvx2())
+                continue;
+            spectrum::StreamingAnalyzer analyzer;
+            carriers.clear();
+            const auto start = Clock::now();
+            analyzer.begin(sample_rate, samples.size(), static_cast<execution::Backend>(backend), &pool);
+            analyzer.feed(samples, carriers);
+            const std::chrono::duration<double> time = Clock::now() - start;
+            output::line() << "\t" << execution::kBackendNames[backend] << ": " << samples.size() / time.count()
+                           << " отсчетов/с, быстрее реального времени в " << seconds / time.count()
+                           << " раз, несущих " << carriers.size();
+        }
+    }
+}
+
+void runDepthMap(concurrency::TaskPool& pool, size_t frames) {
+    static constexpr std::pair<unsigned, unsigned> kResolutions[] = {{1280, 720}, {1920, 1080}};
+    // Количество различных кадров, по кругу подаваемых построителю, и животных в каждом кадре
+    static constexpr size_t kDistinctFrames = 8;
+    static constexpr size_t kAnimals        = 3;
+    prng::seed(1);
+    std::vector<pantomime::Video> videos(kDistinctFrames);
+    std::vector<double> distances(kDistinctFrames);
+    for (auto [width, height] : kResolutions) {
+        for (size_t iter = 0; iter < kDistinctFrames; iter++) {
+            videos[iter].figures.clear();
+            for (size_t animal = 0; animal < kAnimals; animal++)
+                videos[iter].figures.push_back(animal::random::generateAnimal().animal.body);
+            distances[iter] = animal::random::renderVideo(videos[iter], width, height);
+        }
+        output::line() << "Замер карты глубины: " << width << "x" << height << ", кадров " << frames;
+        for (size_t backend = 0; backend < execution::kMaxBackend; backend++) {
+            depth::DepthMapper mapper(&pool);
+            size_t figures   = 0;
+            const auto start = Clock::now();
+            for (size_t iter = 0; iter < frames; iter++) {
+                mapper.build(videos[iter % kDistinctFrames].view(), distances[iter % kDistinctFrames],
+                             static_cast<execution::Backend>(backend));
+                figures += mapper.segment().size();
+            }
+            const std::chrono::duration<double> time = Clock::now() - start;
+            output::line() << "\t" << execution::kBackendNames[backend] << ": " << frames / time.count()
+                           << " кадров/с, фигур в кадре " << (double)figures / frames;
+        }
+    }
+}
+
+bool runAllocations(concurrency::TaskPool& pool, size_t frames) {
+    // Различные беседы, по кругу подаваемые устройству (первый круг - разогрев), и животных в каждой беседе
+    static constexpr size_t kDistinctFrames = 4;
+    static constexpr size_t kAnimals        = 3;
+    // Поток микрофона вмещает беседу целиком, поэтому звук записывается до начала обработки кадра
+    static constexpr size_t kAudioCapacity = 1 << 19;
+    prng::seed(1);
+    std::vector<animal::Frame> conversations(kDistinctFrames);
+    std::vector<std::vector<float>> samples(kDistinctFrames);
+    for (size_t iter = 0; iter < kDistinctFrames; iter++) {
+        animal::Frame& frame = conversations[iter];
+        for (size_t count = 0; count < kAnimals; count++) {
+            const animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
+            frame.video.figures.push_back(animal.animal.body);
+            frame.noise.noises.push_back(animal.animal.sound);
+            frame.types.types.push_back(animal.animal_type);
+        }
+        frame.distance = animal::random::renderVideo(frame.video, pantomime::kFrameWidth, pantomime::kFrameHeight);
+        frame.noise.sample_rate  = syllable::kDefaultSampleRate;
+        frame.noise.sample_count = animal::random::noiseLength(frame.noise, frame.noise.sample_rate);
+        samples[iter].resize(frame.noise.sample_count);
+        animal::random::renderNoise(frame.noise, frame.noise.sample_rate, 0, samples[iter]);
+    }
+    concurrency::ReadinessEvent ready;
+    animal::FrameBus bus(ready);
+    animal::FrameRing& lane = bus.lane(bus.addLane(kDistinctFrames));
+    animal::AudioRing audio(kAudioCapacity);
+    translator::AnimalTranslatinator device(bus, audio, pool);
+    device.setPower(true);
+    device.setQuiet(true);
+    device.setProjection(false);
+    // Копия беседы создается до замера, датчики получают ее вместе со звуком
+    auto publish = [&](animal::Frame& frame, size_t iter) {
+        frame.noise.sample_begin = audio.written();
+        lane.push(std::move(frame));
+        ready.notify();
+        audio.write(samples[iter % kDistinctFrames]);
+    };
+
+    output::line() << "Проверка выделений памяти: кадров " << frames << " в каждом режиме после разогрева на "
+                   << kDistinctFrames << " кадрах";
+    output::Sink& sink = output::sink();
+    const bool quiet   = sink.quiet();
+    sink.flush();
+    sink.setQuiet(true);
+    std::array<size_t, 3> allocations{};
+    for (bool parallel : {false, true}) {
+        device.setParallelFormatting(parallel);
+        for (size_t iter = 0; iter < kDistinctFrames + frames; iter++) {
+            animal::Frame frame = conversations[iter % kDistinctFrames];
+            publish(frame, iter);
+            const translator::ListenTiming timing = device.startListening();
+            if (iter >= kDistinctFrames)
+                allocations[parallel] += timing.allocations;
+        }
+    }
+    device.startStreaming();
+    for (size_t iter = 0; iter < kDistinctFrames + frames; iter++) {
+        animal::Frame frame = conversations[iter % kDistinctFrames];
+        const size_t before = memory::allocations();
+        publish(frame, iter);
+        while (device.streamedFrames() <= iter) std::this_thread::yield();
+        if (iter >= kDistinctFrames)
+            allocations[2] += memory::allocations() - before;
+    }
+    device.stopStreaming();
+    sink.setQuiet(quiet);
+
+    static constexpr const char* kModeNames[] = {"прослушивание, видео и звук по очереди",
+                                                 "прослушивание, видео и звук одновременно", "потоковый режим"};
+    for (size_t mode = 0; mode < allocations.size(); mode++)
+        output::line() << "\t" << kModeNames[mode] << ": выделений памяти " << allocations[mode];
+    const bool passed = std::all_of(allocations.begin(), allocations.end(), [](size_t count) { return count == 0; });
+    output::line() << (passed ? "Проверка пройдена: обработка кадра не выделяет память"
+                              : "ОШИБКА: обработка кадра выделяет память");
+    return passed;
+}
+
+}  // namespace bench
@@ -0,0 +1,252 @@
+#include "depth_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DEPTH_MAP_X86 1
+#endif
+
+namespace depth {
+
+namespace {
+
+/// @brief Исправление диспаритета без ветвлений: значение вычисляется для каждого пикселя и обнуляется маской фона
+void correctScalar(const uint8_t* disparity, uint8_t* corrected, size_t count, int bias) {
+    for (size_t iter = 0; iter < count; iter++) {
+        const int value   = std::clamp(disparity[iter] - bias, 0, 255);
+        corrected[iter]   = (uint8_t)(value & -(int)(value >= DepthMapper::kMinDisparity && disparity[iter] != 0));
+    }
+}
+
+#ifdef DEPTH_MAP_X86
+
+__attribute__((target("avx2"))) void correctAvx2(const uint8_t* disparity, uint8_t* corrected, size_t count,
+                                                  int bias) {
+    constexpr size_t kLanes = 32;
+    // Вычитание поправки с насыщением совпадает с ограничением результата диапазоном [0, 255]
+    const __m256i shift        = _mm256_set1_epi8((char)std::min(std::abs(bias), 255));
+    const __m256i min_disparity = _mm256_set1_epi8((char)DepthMapper::kMinDisparity);
+    const __m256i zero          = _mm256_setzero_si256();
+    size_t iter                 = 0;
+    for (; iter + kLanes <= count; iter += kLanes) {
+        const __m256i raw   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(disparity + iter));
+        const __m256i value = bias >= 0 ? _mm256_subs_epu8(raw, shift) : _mm256_adds_epu8(raw, shift);
+        // Передний план: значение не меньше kMinDisparity и исходный пиксель не пустой
+        const __m256i foreground = _mm256_andnot_si256(
+            _mm256_cmpeq_epi8(raw, zero), _mm256_cmpeq_epi8(_mm256_max_epu8(value, min_disparity), value));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(corrected + iter), _mm256_and_si256(value, foreground));
+    }
+    correctScalar(disparity + iter, corrected + iter, count - iter, bias);
+}
+
+#endif
+
+/// @brief Исправление диспаритета выбранной реализацией
+void correctRange(const uint8_t* disparity, uint8_t* corrected, size_t count, int bias, bool simd) {
+#ifdef DEPTH_MAP_X86
+    if (simd) {
+        correctAvx2(disparity, corrected, count, bias);
+        return;
+    }
+#endif
+    correctScalar(disparity, corrected, count, bias);
+}
+
+}  // namespace
+
+void DepthMapper::build(const pantomime::VideoView& video, double distance, execution::Backend backend) {
+    width_   = video.width;
+    height_  = video.height;
+    bias_    = 0;
+    backend_ = backend == execution::kThreaded && !pool_ ? execution::kSimd : backend;
+    if (video.disparity.size() != (size_t)width_ * height_) {
+        width_  = 0;
+        height_ = 0;
+    }
+    // Ошибка калибровки - разница измеренного и ожидаемого по дальномеру диспаритета центрального пикселя
+    const size_t center = (size_t)(height_ / 2) * width_ + width_ / 2;
+    if (width_ != 0 && distance > 0 && video.disparity[center] != 0) {
+        const long expected = std::lround(pantomime::kFocalLength * pantomime::kStereoBaseline / distance);
+        bias_               = video.disparity[center] - (int)expected;
+    }
+    correct(video.disparity.first((size_t)width_ * height_));
+}
+
+void DepthMapper::correct(std::span<const uint8_t> disparity) {
+    disparity_.resize(disparity.size());
+    const bool simd = backend_ != execution::kScalar && execution::hasAvx2();
+    if (backend_ != execution::kThreaded) {
+        correctRange(disparity.data(), disparity_.data(), disparity.size(), bias_, simd);
+        return;
+    }
+    // Полосы строк высотой в блок исправляются независимо
+    pool_->parallelFor(height_, kTileSize, [this, disparity, simd](size_t begin, size_t end) {
+        const size_t first = begin * width_;
+        correctRange(disparity.data() + first, disparity_.data() + first, (end - begin) * width_, bias_, simd);
+    });
+}
+
+std::span<const Component> DepthMapper::segment() {
+    components_.clear();
+    if (width_ == 0 || height_ == 0)
+        return components_;
+    labels_.assign(disparity_.size(), 0);
+    parent_.assign(1, 0);
+    if (backend_ == execution::kThreaded) {
+        labelTilesParallel();
+    } else {
+        for (unsigned y0 = 0; y0 < height_; y0 += kTileSize) {
+            for (unsigned x0 = 0; x0 < width_; x0 += kTileSize)
+                labelTile(x0, y0, std::min(x0 + kTileSize, width_), std::min(y0 + kTileSize, height_), parent_);
+        }
+    }
+    mergeTiles();
+
+    // Собираем признаки областей за один проход по кадру
+    compact_.assign(parent_.size(), -1);
+    for (unsigned y = 0; y < height_; y++) {
+        const size_t row = (size_t)y * width_;
+        for (unsigned x = 0; x < width_; x++) {
+            const int32_t label = labels_[row + x];
+            if (label == 0)
+                continue;
+            const int32_t root = find(parent_, label);
+            if (compact_[root] < 0) {
+                compact_[root] = (int32_t)components_.size();
+                components_.push_back((Component){.left = x, .right = x, .top = y, .bottom = y});
+            }
+            Component& component = components_[compact_[root]];
+            component.area++;
+            component.sum_x += x;
+            component.sum_disparity += disparity_[row + x];
+            component.left   = std::min(component.left, x);
+            component.right  = std::max(component.right, x);
+            component.bottom = y;
+        }
+    }
+    auto noise = std::remove_if(components_.begin(), components_.end(),
+                                [](const Component& component) { return component.area < kMinArea; });
+    components_.erase(noise, components_.end());
+    // Области упорядочиваются слева направо
+    std::sort(components_.begin(), components_.end(),
+              [](const Component& first, const Component& second) { return first.centerX() < second.centerX(); });
+    return components_;
+}
+
+double DepthMapper::depth(const Component& component) const {
+    return pantomime::kFocalLength * pantomime::kStereoBaseline / component.disparity();
+}
+
+double DepthMapper::size(const Component& component) const {
+    return (component.bottom - component.top + 1) * depth(component) / pantomime::kFocalLength * 100;
+}
+
+void DepthMapper::labelTile(unsigned x0, unsigned y0, unsigned x1, unsigned y1, std::vector<int32_t>& parent) {
+    for (unsigned y = y0; y < y1; y++) {
+        const size_t row = (size_t)y * width_;
+        for (unsigned x = x0; x < x1; x++) {
+            const size_t pixel = row + x;
+            if (disparity_[pixel] == 0)
+                continue;
+            // Соседи слева и сверху уже размечены; соседи из других блоков объединяются позже
+            int32_t label = 0;
+            if (x > x0 && connected(pixel, pixel - 1))
+                label = labels_[pixel - 1];
+            if (y > y0 && connected(pixel, pixel - width_)) {
+                if (label == 0)
+                    label = labels_[pixel - width_];
+                else
+                    unite(parent, label, labels_[pixel - width_]);
+            }
+            if (label == 0) {
+                label = (int32_t)parent.size();
+                parent.push_back(label);
+            }
+            labels_[pixel] = label;
+        }
+    }
+}
+
+void DepthMapper::labelTilesParallel() {
+    const unsigned columns = (width_ + kTileSize - 1) / kTileSize;
+    const size_t tiles     = (size_t)columns * ((height_ + kTileSize - 1) / kTileSize);
+    auto forEachTile       = [this, columns](size_t tile, auto&& body) {
+        const unsigned x0 = tile % columns * kTileSize;
+        const unsigned y0 = tile / columns * kTileSize;
+        body(x0, y0, std::min(x0 + kTileSize, width_), std::min(y0 + kTileSize, height_));
+    };
+    // Блоки размечаются независимо, каждый со своим лесом меток, начинающихся с 1
+    tile_parents_.resize(tiles);
+    pool_->parallelFor(tiles, 1, [this, &forEachTile](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; tile++) {
+            tile_parents_[tile].assign(1, 0);
+            forEachTile(tile, [this, tile](unsigned x0, unsigned y0, unsigned x1, unsigned y1) {
+                labelTile(x0, y0, x1, y1, tile_parents_[tile]);
+            });
+        }
+    });
+    // Метки блока сдвигаются на количество меток предыдущих блоков
+    tile_offsets_.resize(tiles);
+    for (size_t tile = 0; tile < tiles; tile++) {
+        const int32_t offset = (int32_t)parent_.size() - 1;
+        tile_offsets_[tile]  = offset;
+        for (size_t label = 1; label < tile_parents_[tile].size(); label++)
+            parent_.push_back(tile_parents_[tile][label] + offset);
+    }
+    pool_->parallelFor(tiles, 1, [this, &forEachTile](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; tile++) {
+            const int32_t offset = tile_offsets_[tile];
+            if (offset == 0)
+                continue;
+            forEachTile(tile, [this, offset](unsigned x0, unsigned y0, unsigned x1, unsigned y1) {
+                for (unsigned y = y0; y < y1; y++) {
+                    int32_t* row = labels_.data() + (size_t)y * width_;
+                    for (unsigned x = x0; x < x1; x++) row[x] += offset & -(int32_t)(row[x] != 0);
+                }
+            });
+        }
+    });
+}
+
+void DepthMapper::mergeTiles() {
+    for (unsigned x = kTileSize; x < width_; x += kTileSize) {
+        for (unsigned y = 0; y < height_; y++) {
+            const size_t pixel = (size_t)y * width_ + x;
+            if (connected(pixel, pixel - 1))
+                unite(parent_, labels_[pixel], labels_[pixel - 1]);
+        }
+    }
+    for (unsigned y = kTileSize; y < height_; y += kTileSize) {
+        const size_t row = (size_t)y * width_;
+        for (unsigned x = 0; x < width_; x++) {
+            if (connected(row + x, row + x - width_))
+                unite(parent_, labels_[row + x], labels_[row + x - width_]);
+        }
+    }
+}
+
+bool DepthMapper::connected(size_t first, size_t second) const {
+    return disparity_[first] != 0 && disparity_[second] != 0 &&
+           std::abs(disparity_[first] - disparity_[second]) <= kDepthStep;
+}
+
+int32_t DepthMapper::find(std::vector<int32_t>& parent, int32_t label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label         = parent[label];
+    }
+    return label;
+}
+
+void DepthMapper::unite(std::vector<int32_t>& parent, int32_t first, int32_t second) {
+    first  = find(parent, first);
+    second = find(parent, second);
+    if (first < second)
+        parent[second] = first;
+    else if (second < first)
+        parent[first] = second;
+}
+
+}  // namespace depth
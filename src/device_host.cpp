@@ -0,0 +1,236 @@
+#include "device_host.h"
+
+#include "output.h"
+#include "prng.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace host {
+
+/// @brief Емкость потока микрофона устройства на узле (звук на узле не передается)
+static constexpr size_t kDeviceAudioCapacity = 1024;
+/// @brief Период опроса устройств, если события готовности недоступны через epoll
+static constexpr int kPollTimeoutMs = 10;
+
+DeviceHost::Device::Device(concurrency::TaskPool& pool, unsigned priority)
+    : frames(ready),
+      audio(kDeviceAudioCapacity),
+      translator(frames, audio, pool),
+      priority(std::max(priority, 1u)) {
+    frames.addLane(kInputCapacity);
+    translator.setQuiet(true);
+    // Устройства обрабатываются параллельно друг другу, поэтому внутри устройства обработка последовательная
+    translator.setParallelFormatting(false);
+    translator.setPower(true);
+}
+
+DeviceHost::DeviceHost(concurrency::TaskPool& pool) : pool_(pool) {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+DeviceHost::~DeviceHost() {
+    stop();
+#ifdef __linux__
+    if (epoll_fd_ >= 0)
+        ::close(epoll_fd_);
+#endif
+}
+
+size_t DeviceHost::addDevice(unsigned priority) {
+    devices_.push_back(std::make_unique<Device>(pool_, priority));
+    return devices_.size() - 1;
+}
+
+void DeviceHost::start() {
+    if (running_.load(std::memory_order_acquire))
+        return;
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+        // Устройства регистрируются по указателю, событие пробуждения - по пустому указателю
+        epoll_event event = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_.fd(), &event);
+        for (auto& device : devices_) {
+            event.data.ptr = device.get();
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, device->ready.fd(), &event);
+        }
+    }
+#endif
+    running_.store(true, std::memory_order_release);
+    scheduler_ = std::thread(&DeviceHost::schedule, this);
+}
+
+void DeviceHost::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel))
+        return;
+    wakeup_.notify();
+    scheduler_.join();
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, wakeup_.fd(), nullptr);
+        for (auto& device : devices_) epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, device->ready.fd(), nullptr);
+    }
+#endif
+}
+
+std::vector<DeviceStats> DeviceHost::stats() const {
+    std::vector<DeviceStats> result;
+    for (const auto& device : devices_)
+        result.push_back((DeviceStats){.priority = device->priority,
+                                       .frames   = device->frames_done.load(std::memory_order_relaxed),
+                                       .animals  = device->animals_done.load(std::memory_order_relaxed)});
+    return result;
+}
+
+void DeviceHost::schedule() {
+    trace::nameThread("узел: планировщик");
+#ifdef __linux__
+    std::array<epoll_event, 64> events;
+#endif
+    while (running_.load(std::memory_order_acquire)) {
+        int count = -1;
+#ifdef __linux__
+        if (epoll_fd_ >= 0)
+            count = epoll_wait(epoll_fd_, events.data(), events.size(), in_flight_ > 0 ? -1 : kPollTimeoutMs);
+#endif
+        if (count < 0) {
+            // Без epoll устройства опрашиваются напрямую
+            wakeup_.waitFor(std::chrono::milliseconds(kPollTimeoutMs));
+            for (auto& device : devices_) {
+                if (device->frames.size() > 0)
+                    enqueue(*device);
+            }
+        }
+#ifdef __linux__
+        for (int iter = 0; iter < count; iter++) {
+            auto* device = static_cast<Device*>(events[iter].data.ptr);
+            if (!device) {
+                wakeup_.consume();
+                continue;
+            }
+            device->ready.consume();
+            enqueue(*device);
+        }
+#endif
+        while (auto device = completed_.tryPop()) complete(**device);
+        dispatch();
+    }
+    // Дожидаемся задач, уже выданных пулу: они обращаются к устройствам узла
+    for (; in_flight_ > 0; in_flight_--) completed_.pop();
+    active_.clear();
+    for (auto& device : devices_) {
+        device->queued  = false;
+        device->busy    = false;
+        device->deficit = 0;
+    }
+}
+
+void DeviceHost::enqueue(Device& device) {
+    if (device.queued || device.busy)
+        return;
+    device.queued = true;
+    active_.push_back(&device);
+}
+
+void DeviceHost::dispatch() {
+    while (in_flight_ < pool_.size() && !active_.empty()) {
+        Device& device = *active_.front();
+        active_.pop_front();
+        device.queued = false;
+        device.busy   = true;
+        device.deficit += kQuantum * device.priority;
+        in_flight_++;
+        pool_.submit([this, &device, budget = device.deficit] {
+            size_t animals = 0;
+            device.served  = device.translator.serve(budget, animals);
+            device.frames_done.fetch_add(device.served, std::memory_order_relaxed);
+            device.animals_done.fetch_add(animals, std::memory_order_relaxed);
+            completed_.push(&device);
+            wakeup_.notify();
+        });
+    }
+}
+
+void DeviceHost::complete(Device& device) {
+    in_flight_--;
+    device.busy = false;
+    // Устройство, у которого кончились кадры, теряет неизрасходованный остаток
+    if (device.served < device.deficit && device.frames.size() == 0) {
+        device.deficit = 0;
+        return;
+    }
+    device.deficit -= std::min(device.served, device.deficit);
+    enqueue(device);
+}
+
+void runBenchmark(concurrency::TaskPool& pool, size_t device_count, double seconds) {
+    static constexpr size_t kMaxFeeders   = 4;
+    static constexpr unsigned kPriorities = 4;
+    DeviceHost host(pool);
+    for (size_t iter = 0; iter < device_count; iter++) host.addDevice(iter % kPriorities + 1);
+    host.start();
+
+    // Каждый источник обслуживает свою часть устройств и держит их входы заполненными
+    std::atomic<bool> feeding{true};
+    std::vector<std::thread> feeders;
+    const size_t feeder_count = std::min(device_count, kMaxFeeders);
+    for (size_t feeder = 0; feeder < feeder_count; feeder++) {
+        feeders.emplace_back([&host, &feeding, feeder, feeder_count, device_count] {
+            prng::seed(feeder + 1);
+            while (feeding.load(std::memory_order_acquire)) {
+                bool fed = false;
+                for (size_t device = feeder; device < device_count; device += feeder_count) {
+                    animal::FrameRing& input = host.input(device);
+                    if (input.size() >= DeviceHost::kInputCapacity / 2)
+                        continue;
+                    animal::Frame frame;
+                    const size_t animal_count = prng::local().between(1, 4);
+                    for (size_t iter = 0; iter < animal_count; iter++) {
+                        animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
+                        frame.video.figures.push_back(animal.animal.body);
+                        frame.noise.noises.push_back(animal.animal.sound);
+                        frame.types.types.push_back(animal.animal_type);
+                    }
+                    input.push(std::move(frame));
+                    host.notify(device);
+                    fed = true;
+                }
+                if (!fed)
+                    std::this_thread::yield();
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    feeding.store(false, std::memory_order_release);
+    for (auto& feeder : feeders) feeder.join();
+    host.stop();
+
+    const auto stats = host.stats();
+    size_t frames = 0, animals = 0;
+    std::array<size_t, kPriorities + 1> priority_frames{}, priority_devices{};
+    for (const auto& device : stats) {
+        frames += device.frames;
+        animals += device.animals;
+        priority_frames[device.priority] += device.frames;
+        priority_devices[device.priority]++;
+    }
+    output::Line line(output::sink());
+    line << "Устройств " << device_count << ": кадров " << frames << ", животных " << animals << ", "
+         << frames / seconds << " кадров/с";
+    // Доля обслуживания: кадров на устройство каждого приоритета относительно приоритета 1
+    const double base = priority_devices[1] ? (double)priority_frames[1] / priority_devices[1] : 0;
+    line << ", обслуживание по приоритетам";
+    for (unsigned priority = 1; priority <= kPriorities; priority++) {
+        if (priority_devices[priority] && base > 0)
+            line << " " << priority << ":" << (double)priority_frames[priority] / priority_devices[priority] / base;
+    }
+}
+
+}  // namespace host
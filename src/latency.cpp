@@ -0,0 +1,178 @@
+#include "latency.h"
+
+#include "output.h"
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace latency {
+
+namespace {
+
+/// @brief Гистограммы стадий одного потока
+struct ThreadHistograms {
+    std::array<Histogram, kMaxStage> stages;
+    /// @brief Гистограммы заняты работающим потоком; гистограммы завершившегося потока переходят следующему
+    std::atomic<bool> owned{true};
+};
+
+/// @brief Объединенные значения гистограмм стадии
+struct Merged {
+    std::array<uint64_t, Histogram::kBuckets> counts{};
+    uint64_t sum = 0;
+};
+
+/*!
+ * @brief Реестр гистограмм всех потоков
+ * Блокировка берется только при первом измерении в потоке и при построении статистики. Гистограммы не
+ * освобождаются до завершения программы, поэтому измерения завершившихся потоков остаются в статистике.
+ */
+class Registry {
+public:
+    ThreadHistograms* acquire() {
+        std::lock_guard lock(mu_);
+        for (auto& histograms : threads_) {
+            bool expected = false;
+            if (histograms->owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return histograms.get();
+        }
+        threads_.push_back(std::make_unique<ThreadHistograms>());
+        return threads_.back().get();
+    }
+
+    /// @brief Объединение гистограмм всех потоков
+    std::array<Merged, kMaxStage> merge() {
+        std::lock_guard lock(mu_);
+        return mergeLocked();
+    }
+
+    /// @brief Запоминание текущих значений как нулевой точки статистики
+    void reset() {
+        std::lock_guard lock(mu_);
+        baseline_ = mergeLocked();
+    }
+
+    /// @brief Объединение гистограмм с вычетом нулевой точки
+    std::array<Merged, kMaxStage> sinceReset() {
+        std::lock_guard lock(mu_);
+        std::array<Merged, kMaxStage> merged = mergeLocked();
+        for (size_t stage = 0; stage < kMaxStage; stage++) {
+            for (size_t bucket = 0; bucket < Histogram::kBuckets; bucket++)
+                merged[stage].counts[bucket] -= baseline_[stage].counts[bucket];
+            merged[stage].sum -= baseline_[stage].sum;
+        }
+        return merged;
+    }
+
+private:
+    std::array<Merged, kMaxStage> mergeLocked() const {
+        std::array<Merged, kMaxStage> merged;
+        for (const auto& histograms : threads_) {
+            for (size_t stage = 0; stage < kMaxStage; stage++) {
+                const Histogram& histogram = histograms->stages[stage];
+                for (size_t bucket = 0; bucket < Histogram::kBuckets; bucket++)
+                    merged[stage].counts[bucket] += histogram.count(bucket);
+                merged[stage].sum += histogram.sum();
+            }
+        }
+        return merged;
+    }
+
+    std::mutex mu_;
+    std::vector<std::unique_ptr<ThreadHistograms>> threads_;
+    std::array<Merged, kMaxStage> baseline_;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/// @brief Гистограммы текущего потока; при завершении потока возвращаются в реестр
+class Lease {
+public:
+    Lease() : histograms(registry().acquire()) {}
+
+    ~Lease() { histograms->owned.store(false, std::memory_order_release); }
+
+    ThreadHistograms* const histograms;
+};
+
+/// @brief Значение, не превышаемое долей quantile учтенных значений, мкс
+double percentile(const Merged& merged, uint64_t total, double quantile) {
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(quantile * total));
+    uint64_t seen       = 0;
+    for (size_t bucket = 0; bucket < Histogram::kBuckets; bucket++) {
+        seen += merged.counts[bucket];
+        if (seen >= rank)
+            return Histogram::highest(bucket) / 1e3;
+    }
+    return 0;
+}
+
+}  // namespace
+
+/// @brief Гистограммы текущего потока
+static ThreadHistograms& local() {
+    thread_local Lease lease;
+    return *lease.histograms;
+}
+
+void record(Stage stage, uint64_t ns) { local().stages[stage].record(ns); }
+
+void attachThread() { local(); }
+
+std::array<Summary, kMaxStage> summarize() {
+    const std::array<Merged, kMaxStage> merged = registry().sinceReset();
+    std::array<Summary, kMaxStage> summaries{};
+    for (size_t stage = 0; stage < kMaxStage; stage++) {
+        uint64_t total = 0;
+        size_t last    = 0;
+        for (size_t bucket = 0; bucket < Histogram::kBuckets; bucket++) {
+            total += merged[stage].counts[bucket];
+            if (merged[stage].counts[bucket] > 0)
+                last = bucket;
+        }
+        if (total == 0)
+            continue;
+        summaries[stage] = (Summary){.count = total,
+                                     .mean  = merged[stage].sum / 1e3 / total,
+                                     .p50   = percentile(merged[stage], total, 0.5),
+                                     .p99   = percentile(merged[stage], total, 0.99),
+                                     .p999  = percentile(merged[stage], total, 0.999),
+                                     .max   = Histogram::highest(last) / 1e3};
+    }
+    return summaries;
+}
+
+void reset() { registry().reset(); }
+
+void print() {
+    const auto summaries = summarize();
+    output::line() << "Задержки стадий, мкс (количество, среднее, p50, p99, p999, максимум):";
+    for (size_t stage = 0; stage < kMaxStage; stage++) {
+        const Summary& summary = summaries[stage];
+        if (summary.count == 0)
+            continue;
+        output::line() << "\t" << kStageNames[stage] << ": " << summary.count << ", " << summary.mean << ", "
+                       << summary.p50 << ", " << summary.p99 << ", " << summary.p999 << ", " << summary.max;
+    }
+}
+
+bool exportCsv(const std::string& path) {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    const auto summaries = summarize();
+    file << "stage,count,mean_us,p50_us,p99_us,p999_us,max_us\n";
+    for (size_t stage = 0; stage < kMaxStage; stage++) {
+        const Summary& summary = summaries[stage];
+        file << kStageNames[stage] << ',' << summary.count << ',' << summary.mean << ',' << summary.p50 << ','
+             << summary.p99 << ',' << summary.p999 << ',' << summary.max << '\n';
+    }
+    return (bool)file;
+}
+
+}  // namespace latency
@@ -0,0 +1,96 @@
+#include "load_generator.h"
+
+#include "output.h"
+#include "prng.h"
+#include "trace.h"
+
+namespace reactor {
+
+bool LoadGenerator::start(const LoadProfile& profile) {
+    if (running()) {
+        output::line() << "Нагрузка уже запущена";
+        return false;
+    }
+    if (profile.producers == 0 || profile.producers > maxProducers() || profile.min_animals == 0 ||
+        profile.min_animals > profile.max_animals || profile.duration <= 0 || profile.frames_per_second < 0 ||
+        profile.persistence < 0 || profile.persistence > 1) {
+        output::line() << "Недопустимые параметры нагрузки (источников не более " << maxProducers() << ")";
+        return false;
+    }
+    // Потоки предыдущей нагрузки уже завершились, но еще не присоединены
+    for (auto& thread : threads_) thread.join();
+    threads_.clear();
+    profile_          = profile;
+    dropped_at_start_ = bus_.dropped();
+    produced_.store(0, std::memory_order_relaxed);
+    animals_.store(0, std::memory_order_relaxed);
+    stopping_.store(false, std::memory_order_relaxed);
+    active_.store(profile.producers, std::memory_order_release);
+    start_ = Clock::now();
+    output::line() << "Запускаем нагрузку: источников " << profile.producers << ", " << profile.frames_per_second
+                   << " кадров/с, " << profile.duration << " с";
+    for (size_t iter = 0; iter < profile.producers; iter++) threads_.emplace_back(&LoadGenerator::produce, this, iter);
+    return true;
+}
+
+void LoadGenerator::stop() {
+    stopping_.store(true, std::memory_order_release);
+    for (auto& thread : threads_) thread.join();
+    threads_.clear();
+}
+
+void LoadGenerator::produce(size_t producer) {
+    trace::nameThread("нагрузка " + std::to_string(producer));
+    prng::seed(profile_.seed + producer);
+    prng::Xoshiro256& generator = prng::local();
+    animal::FrameRing& lane     = bus_.lane(first_lane_ + producer);
+    const auto deadline = start_ + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double>(profile_.duration));
+    // Источники делят общую частоту кадров поровну
+    const auto interval = profile_.frames_per_second > 0
+                              ? std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double>(profile_.producers / profile_.frames_per_second))
+                              : Clock::duration::zero();
+    // Животные прошлого кадра: неподвижные животные переходят в следующий кадр без изменений
+    std::vector<animal::DecodedAnimalCharacteristic> herd;
+    auto next = start_;
+    while (!stopping_.load(std::memory_order_acquire) && Clock::now() < deadline) {
+        TRACE_SCOPE("LoadGenerator::produce");
+        const size_t animal_count = generator.between(profile_.min_animals, profile_.max_animals + 1);
+        animal::Frame frame;
+        herd.resize(std::min(herd.size(), animal_count));
+        for (size_t iter = 0; iter < animal_count; iter++) {
+            if (iter == herd.size())
+                herd.push_back(animal::random::generateAnimal());
+            else if (generator.real() >= profile_.persistence)
+                herd[iter] = animal::random::generateAnimal();
+            const animal::DecodedAnimalCharacteristic& animal = herd[iter];
+            frame.video.figures.push_back(animal.animal.body);
+            frame.noise.noises.push_back(animal.animal.sound);
+            frame.types.types.push_back(animal.animal_type);
+        }
+        if (profile_.render_video)
+            frame.distance = animal::random::renderVideo(frame.video, pantomime::kFrameWidth, pantomime::kFrameHeight);
+        lane.push(std::move(frame));
+        bus_.ready().notify();
+        produced_.fetch_add(1, std::memory_order_relaxed);
+        animals_.fetch_add(animal_count, std::memory_order_relaxed);
+        if (interval != Clock::duration::zero()) {
+            next += interval;
+            std::this_thread::sleep_until(std::min(next, deadline));
+        }
+    }
+    // Итоги выводит последний завершившийся источник
+    if (active_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        report();
+}
+
+void LoadGenerator::report() const {
+    const std::chrono::duration<double> elapsed = Clock::now() - start_;
+    const size_t produced                       = produced_.load(std::memory_order_relaxed);
+    output::line() << "Нагрузка окончена: кадров " << produced << ", животных "
+                   << animals_.load(std::memory_order_relaxed) << ", вытеснено " << bus_.dropped() - dropped_at_start_
+                   << ", за " << elapsed.count() << " с (" << produced / elapsed.count() << " кадров/с)";
+}
+
+}  // namespace reactor
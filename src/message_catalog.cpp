@@ -0,0 +1,160 @@
+#include "message_catalog.h"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace messages {
+
+namespace {
+
+/// @brief Встроенные тексты, используемые до загрузки каталога из файла
+std::vector<LocaleTexts> builtinLocales() {
+    return {
+        {"ru", {"Хочу гуляш", "Lorem Ipsum", "Бойся меня, кожаный мешок", "Давай играть"}},
+        {"en", {"I want goulash", "Lorem Ipsum", "Afraid of me, leather bag", "Let's play"}},
+    };
+}
+
+const Catalog& builtin() {
+    static const Catalog catalog(builtinLocales());
+    return catalog;
+}
+
+/// @brief Загруженный из файла каталог; nullptr, пока используется встроенный
+std::atomic<const Catalog*> active{nullptr};
+
+/// @brief Все загруженные каталоги; освобождаются только при завершении процесса
+std::mutex loaded_mu;
+std::vector<std::unique_ptr<const Catalog>> loaded;
+
+std::string_view trim(std::string_view text) {
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos)
+        return {};
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+Template parseTemplate(std::string_view name) {
+    for (size_t iter = 0; iter < kMaxTemplate; iter++) {
+        if (name == kTemplateNames[iter])
+            return static_cast<Template>(iter);
+    }
+    return kMaxTemplate;
+}
+
+/*!
+ * @brief Разбор текстового файла каталога
+ * @param[in] file Файл
+ * @param[out] locales Тексты всех языков
+ * @param[out] error Описание первой найденной ошибки
+ */
+bool parse(std::istream& file, std::vector<LocaleTexts>& locales, std::string& error) {
+    std::array<bool, kMaxTemplate> defined{};
+    // Проверка того, что у последнего языка заданы все шаблоны
+    auto complete = [&]() {
+        for (size_t iter = 0; iter < kMaxTemplate && !locales.empty(); iter++) {
+            if (!defined[iter]) {
+                error = "язык " + locales.back().name + ": нет текста шаблона " + kTemplateNames[iter];
+                return false;
+            }
+        }
+        return true;
+    };
+    std::string buffer;
+    for (size_t number = 1; std::getline(file, buffer); number++) {
+        const std::string_view line = trim(buffer);
+        if (line.empty() || line.front() == '#')
+            continue;
+        const std::string where = "строка " + std::to_string(number) + ": ";
+        if (line.starts_with("locale ")) {
+            if (!complete())
+                return false;
+            const std::string_view name = trim(line.substr(line.find(' ')));
+            for (const auto& locale : locales) {
+                if (locale.name == name) {
+                    error = where + "язык " + std::string(name) + " уже задан";
+                    return false;
+                }
+            }
+            locales.push_back({.name = std::string(name)});
+            defined.fill(false);
+            continue;
+        }
+        const size_t equal = line.find('=');
+        if (equal == std::string_view::npos || locales.empty()) {
+            error = where + "ожидается \"locale <название>\" или \"<шаблон> = <текст>\"";
+            return false;
+        }
+        const Template message_template = parseTemplate(trim(line.substr(0, equal)));
+        if (message_template == kMaxTemplate) {
+            error = where + "неизвестный шаблон " + std::string(trim(line.substr(0, equal)));
+            return false;
+        }
+        locales.back().texts[message_template] = trim(line.substr(equal + 1));
+        defined[message_template]              = true;
+    }
+    if (!complete())
+        return false;
+    if (locales.empty() || locales.size() >= kNoLocale) {
+        error = locales.empty() ? "в файле нет ни одного языка" : "слишком много языков";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+Catalog::Catalog(const std::vector<LocaleTexts>& locales, uint32_t generation) : generation_(generation) {
+    // Сначала собираем буфер и смещения текстов: буфер перевыделяется по мере роста, поэтому ссылки на тексты
+    // строятся после его заполнения
+    std::unordered_map<std::string_view, size_t> interned;
+    auto intern = [&](std::string_view text) {
+        const auto [found, inserted] = interned.try_emplace(text, text_.size());
+        if (inserted)
+            text_ += text;
+        return std::make_pair(found->second, text.size());
+    };
+    std::vector<std::pair<size_t, size_t>> names, table;
+    for (const auto& locale : locales) {
+        names.push_back(intern(locale.name));
+        for (const auto& text : locale.texts) table.push_back(intern(text));
+    }
+    text_.shrink_to_fit();
+    const std::string_view text = text_;
+    for (const auto [offset, size] : names) names_.push_back(text.substr(offset, size));
+    for (const auto [offset, size] : table) table_.push_back(text.substr(offset, size));
+}
+
+Locale Catalog::findLocale(std::string_view name) const {
+    for (size_t locale = 0; locale < names_.size(); locale++) {
+        if (names_[locale] == name)
+            return static_cast<Locale>(locale);
+    }
+    return kNoLocale;
+}
+
+const Catalog& current() {
+    const Catalog* catalog = active.load(std::memory_order_acquire);
+    return catalog ? *catalog : builtin();
+}
+
+bool load(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "не удалось открыть " + path;
+        return false;
+    }
+    std::vector<LocaleTexts> locales;
+    if (!parse(file, locales, error))
+        return false;
+    std::lock_guard lock(loaded_mu);
+    loaded.push_back(std::make_unique<const Catalog>(locales, loaded.size() + 1));
+    active.store(loaded.back().get(), std::memory_order_release);
+    return true;
+}
+
+}  // namespace messages
@@ -0,0 +1,278 @@
+#include "output.h"
+
+#include "animal_types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace output {
+
+/// @brief Названия животных в выводе на монитор
+static constexpr animal::AnimalTable<std::string_view> animal_names =
+    animal::makeAnimalTable<std::string_view>("котика", "собачку", "попугайчика", "корову", "овечку");
+
+/// @brief Размер двоичного заголовка записи
+static constexpr size_t kRecordHeader = offsetof(Record, text);
+
+/*!
+ * @brief Длина префикса текста, умещающегося в limit байт, не разрезая многобайтовый символ UTF-8
+ * @param[in] text Текст
+ * @param[in] limit Наибольшая длина префикса, байт
+ * @return Длина префикса, байт
+ */
+static size_t fittingLength(std::string_view text, size_t limit) {
+    if (text.size() <= limit)
+        return text.size();
+    // Байты продолжения символа имеют вид 10xxxxxx; префикс не может заканчиваться перед таким байтом
+    while (limit > 0 && (static_cast<unsigned char>(text[limit]) & 0xC0) == 0x80) limit--;
+    return limit;
+}
+
+Record makeRecord(RecordType type, std::string_view text, uint32_t value, uint8_t animal) {
+    Record record;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count();
+    record.value  = value;
+    record.length = fittingLength(text, kTextCapacity);
+    record.type   = type;
+    record.animal = animal;
+    std::memcpy(record.text, text.data(), record.length);
+    return record;
+}
+
+TextBackend::~TextBackend() {
+    if (owned_)
+        fclose(file_);
+    else
+        fflush(file_);
+}
+
+void TextBackend::format(const Record& record, std::string& buffer) {
+    switch (record.type) {
+        case RecordType::kText:
+            buffer.append(record.view());
+            buffer.push_back('\n');
+            break;
+        case RecordType::kDisplayBegin: {
+            char count[16];
+            buffer.append("Происходит вывод на экран:\n------------------------------\nНа изображении найдено ");
+            buffer.append(count, std::to_chars(count, count + sizeof(count), record.value).ptr);
+            buffer.append(" животных\n\n");
+        } break;
+        case RecordType::kAnimal:
+            buffer.append("Информация о животном");
+            if (record.value) {
+                char track[16];
+                buffer.append(" №");
+                buffer.append(track, std::to_chars(track, track + sizeof(track), record.value).ptr);
+            }
+            buffer.append(":\nМы видим здесь ");
+            if (record.animal < animal_names.size())
+                buffer.append(animal_names[record.animal]);
+            buffer.append("\nКажется, животное вам хочет сказать следующее:\n");
+            buffer.append(record.view());
+            buffer.append("\n\n");
+            break;
+        case RecordType::kDisplayEnd:
+            buffer.append("------------------------------\n");
+            break;
+    }
+}
+
+void TextBackend::write(std::string_view buffer) { fwrite(buffer.data(), 1, buffer.size(), file_); }
+
+void TextBackend::flush() { fflush(file_); }
+
+BinaryBackend::~BinaryBackend() { fclose(file_); }
+
+void BinaryBackend::format(const Record& record, std::string& buffer) {
+    buffer.append(reinterpret_cast<const char*>(&record), kRecordHeader + record.length);
+}
+
+void BinaryBackend::write(std::string_view buffer) { fwrite(buffer.data(), 1, buffer.size(), file_); }
+
+void BinaryBackend::flush() { fflush(file_); }
+
+std::unique_ptr<Backend> terminal() { return std::make_unique<TextBackend>(stdout, false); }
+
+std::unique_ptr<Backend> textFile(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return nullptr;
+    return std::make_unique<TextBackend>(file, true);
+}
+
+std::unique_ptr<Backend> binaryFile(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return nullptr;
+    return std::make_unique<BinaryBackend>(file);
+}
+
+Sink::Sink(std::unique_ptr<Backend> backend, size_t capacity) : ring_(capacity), backend_(std::move(backend)) {
+    buffer_.reserve(kBufferSize + sizeof(Record) * 2);
+    writer_ = std::thread(&Sink::drain, this);
+}
+
+Sink::~Sink() {
+    stopping_.store(true, std::memory_order_seq_cst);
+    wake();
+    writer_.join();
+}
+
+void Sink::submit(const Record& record) {
+    if (quiet())
+        return;
+    ring_.push(record);
+    // Парная барьеру потока вывода перед сном: либо поток вывода увидит запись, либо писатель увидит, что он спит
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed))
+        wake();
+}
+
+void Sink::wake() {
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+}
+
+void Sink::flush() {
+    const size_t target = ring_.written();
+    for (size_t done = written_.load(std::memory_order_acquire); done < target;
+         done        = written_.load(std::memory_order_acquire))
+        written_.wait(done, std::memory_order_acquire);
+}
+
+void Sink::setBackend(std::unique_ptr<Backend> backend) {
+    std::lock_guard lock(backend_mu_);
+    backend_ = std::move(backend);
+}
+
+SinkStats Sink::stats() const {
+    return (SinkStats){.submitted = ring_.written(),
+                       .written   = written_.load(std::memory_order_relaxed),
+                       .batches   = batches_.load(std::memory_order_relaxed)};
+}
+
+void Sink::drain() {
+    Record record;
+    while (true) {
+        const unsigned epoch = epoch_.load(std::memory_order_acquire);
+        size_t count         = 0;
+        {
+            // Забираем все накопившиеся записи и выводим их одной пачкой
+            std::lock_guard lock(backend_mu_);
+            while (ring_.tryPop(record)) {
+                backend_->format(record, buffer_);
+                count++;
+                if (buffer_.size() >= kBufferSize) {
+                    backend_->write(buffer_);
+                    buffer_.clear();
+                }
+            }
+            if (count > 0) {
+                backend_->write(buffer_);
+                backend_->flush();
+                buffer_.clear();
+                batches_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (count > 0) {
+            written_.fetch_add(count, std::memory_order_release);
+            written_.notify_all();
+            continue;
+        }
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ring_.empty()) {
+            sleeping_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire))
+            break;
+        epoch_.wait(epoch, std::memory_order_acquire);
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+Sink& sink() {
+    static Sink instance(terminal());
+    return instance;
+}
+
+Line::Line(Sink& target) : target_(target), record_(makeRecord(RecordType::kText)), active_(!target.quiet()) {}
+
+Line::~Line() {
+    if (active_)
+        target_.submit(record_);
+}
+
+Line& Line::operator<<(std::string_view text) {
+    if (active_) {
+        const size_t count = fittingLength(text, kTextCapacity - record_.length);
+        std::memcpy(free(), text.data(), count);
+        record_.length += count;
+    }
+    return *this;
+}
+
+void runBenchmark(size_t records) {
+    static constexpr size_t kProducers = 4;
+    const size_t per_producer          = std::max<size_t>(records / kProducers, 1);
+    using Clock                        = std::chrono::steady_clock;
+
+    // Запуск источников; возвращает время, пока источники выводили строки, и общее время до окончания вывода
+    auto measure = [per_producer](auto&& produce, auto&& finish) {
+        const auto start = Clock::now();
+        std::vector<std::thread> producers;
+        for (size_t producer = 0; producer < kProducers; producer++)
+            producers.emplace_back([&produce, producer, per_producer] {
+                for (size_t iter = 0; iter < per_producer; iter++) produce(producer * per_producer + iter);
+            });
+        for (auto& producer : producers) producer.join();
+        const std::chrono::duration<double> enqueue = Clock::now() - start;
+        finish();
+        const std::chrono::duration<double> total = Clock::now() - start;
+        return std::pair{enqueue.count(), total.count()};
+    };
+    const double count = per_producer * kProducers;
+    auto report        = [count](std::string_view name, std::pair<double, double> time) {
+        line() << name << ": " << count / time.first << " строк/с в источниках, " << count / time.second
+               << " строк/с до окончания вывода";
+    };
+
+    {
+        // Синхронный вывод: каждая строка форматируется и сбрасывается под общим потоком вывода
+        std::ofstream null("/dev/null");
+        std::mutex mu;
+        report("Синхронный std::ostream",
+               measure(
+                   [&](size_t index) {
+                       std::lock_guard lock(mu);
+                       null << "Классификация животного " << index << " заняла " << 0.0016 * (index % 7)
+                            << " секунд" << std::endl;
+                   },
+                   [] {}));
+    }
+    for (bool binary : {false, true}) {
+        std::unique_ptr<Backend> backend = binary ? binaryFile("/dev/null") : textFile("/dev/null");
+        if (!backend) {
+            line() << "Не удалось открыть /dev/null для замера вывода";
+            return;
+        }
+        Sink null(std::move(backend));
+        std::pair<double, double> time = measure(
+            [&null](size_t index) {
+                Line(null) << "Классификация животного " << index << " заняла " << 0.0016 * (index % 7) << " секунд";
+            },
+            [&null] { null.flush(); });
+        const SinkStats stats = null.stats();
+        report(binary ? "Асинхронный вывод, двоичные записи" : "Асинхронный вывод, текст", time);
+        line() << "\tзаписей " << stats.written << ", пачек " << stats.batches;
+    }
+}
+
+}  // namespace output
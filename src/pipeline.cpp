@@ -0,0 +1,151 @@
+#include "pipeline.h"
+
+#include "trace.h"
+#include "translator.h"
+
+namespace translator {
+
+StreamingPipeline::StreamingPipeline(Sensor& sensor, Translator& translator, Monitor& monitor)
+    : sensor_(sensor),
+      translator_(translator),
+      monitor_(monitor),
+      sensed_(kStageQueueCapacity),
+      formatted_(kStageQueueCapacity),
+      translated_(kStageQueueCapacity) {}
+
+void StreamingPipeline::start() {
+    if (running())
+        return;
+    sensed_.reopen();
+    formatted_.reopen();
+    translated_.reopen();
+    running_.store(true, std::memory_order_release);
+    threads_.emplace_back(&StreamingPipeline::senseStage, this);
+    threads_.emplace_back(&StreamingPipeline::formatStage, this);
+    threads_.emplace_back(&StreamingPipeline::translateStage, this);
+    threads_.emplace_back(&StreamingPipeline::displayStage, this);
+}
+
+void StreamingPipeline::stop() {
+    running_.store(false, std::memory_order_release);
+    // Стадии завершаются по цепочке: каждая закрывает свою выходную очередь после того, как иссякнет входная
+    for (auto& thread : threads_) thread.join();
+    threads_.clear();
+}
+
+std::array<StreamingPipeline::StageStats, StreamingPipeline::kMaxStage> StreamingPipeline::stats() const {
+    const std::array<size_t, kMaxStage> depth = {sensed_.size(), formatted_.size(), translated_.size(), 0};
+    std::array<StageStats, kMaxStage> result;
+    for (size_t stage = 0; stage < kMaxStage; stage++) {
+        const StageCounters& counters = counters_[stage];
+        result[stage] = (StageStats){
+            .processed       = counters.processed.load(std::memory_order_relaxed),
+            .queue_depth     = depth[stage],
+            .max_queue_depth = counters.max_queue_depth.load(std::memory_order_relaxed),
+            .busy_seconds    = counters.busy_ns.load(std::memory_order_relaxed) / 1e9,
+            .input_stall     = counters.input_stall_ns.load(std::memory_order_relaxed) / 1e9,
+            .output_stall    = counters.output_stall_ns.load(std::memory_order_relaxed) / 1e9,
+        };
+    }
+    return result;
+}
+
+void StreamingPipeline::account(std::atomic<long>& counter, Clock::time_point since) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since);
+    counter.fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
+
+template <typename T>
+bool StreamingPipeline::forward(Stage stage, concurrency::BlockingQueue<T>& queue, T value) {
+    StageCounters& counters = counters_[stage];
+    const auto since        = Clock::now();
+    const bool pushed       = queue.push(std::move(value));
+    account(counters.output_stall_ns, since);
+    counters.processed.fetch_add(1, std::memory_order_relaxed);
+    const size_t depth = queue.size();
+    size_t max_depth   = counters.max_queue_depth.load(std::memory_order_relaxed);
+    while (depth > max_depth && !counters.max_queue_depth.compare_exchange_weak(max_depth, depth)) {
+    }
+    return pushed;
+}
+
+template <typename T>
+bool StreamingPipeline::receive(Stage stage, concurrency::BlockingQueue<T>& queue, T& value) {
+    const auto since    = Clock::now();
+    const bool received = queue.pop(value);
+    account(counters_[stage].input_stall_ns, since);
+    return received;
+}
+
+void StreamingPipeline::senseStage() {
+    trace::nameThread(std::string("конвейер: ") + kStageNames[kSense]);
+    StageCounters& counters = counters_[kSense];
+    while (running()) {
+        // Первичное чтение почти целиком состоит из ожидания беседы, поэтому учитывается как простой на входе
+        const auto since               = Clock::now();
+        animal::PackedData packed_data = sensor_.collectData(kSensePollTimeout);
+        account(counters.input_stall_ns, since);
+        if (packed_data.ready)
+            forward(kSense, sensed_, std::move(packed_data));
+    }
+    sensed_.close();
+}
+
+void StreamingPipeline::formatStage() {
+    trace::nameThread(std::string("конвейер: ") + kStageNames[kFormat]);
+    animal::PackedData packed_data;
+    while (receive(kFormat, sensed_, packed_data)) {
+        const auto since                   = Clock::now();
+        animal::PreparedData prepared_data = sensor_.prepareData(packed_data);
+        account(counters_[kFormat].busy_ns, since);
+        forward(kFormat, formatted_, std::move(prepared_data));
+    }
+    formatted_.close();
+}
+
+void StreamingPipeline::translateStage() {
+    trace::nameThread(std::string("конвейер: ") + kStageNames[kTranslate]);
+    std::vector<animal::PreparedData> batch;
+    std::vector<std::vector<animal::DecodedAnimalCharacteristic>> decoded;
+    animal::PreparedData prepared_data;
+    while (receive(kTranslate, formatted_, prepared_data)) {
+        // Если перевод отстает от датчиков, переводим все накопившиеся кадры одним пакетом
+        batch.clear();
+        batch.push_back(std::move(prepared_data));
+        while (batch.size() < kMaxTranslateBatch) {
+            auto next = formatted_.tryPop();
+            if (!next)
+                break;
+            batch.push_back(std::move(*next));
+        }
+        // Массивы, переданные монитору с прошлыми кадрами, заменяются выведенными им массивами, чтобы перевод
+        // не выделял память под сообщения заново
+        decoded.resize(batch.size());
+        for (size_t frame = 0; frame < batch.size(); frame++) {
+            auto recycled = recycled_.tryPop();
+            if (!recycled)
+                break;
+            decoded[frame] = std::move(*recycled);
+        }
+        const auto since = Clock::now();
+        translator_.translateBatch(batch, decoded);
+        account(counters_[kTranslate].busy_ns, since);
+        for (auto& messages : decoded) forward(kTranslate, translated_, std::move(messages));
+    }
+    translated_.close();
+}
+
+void StreamingPipeline::displayStage() {
+    trace::nameThread(std::string("конвейер: ") + kStageNames[kDisplay]);
+    std::vector<animal::DecodedAnimalCharacteristic> messages;
+    StageCounters& counters = counters_[kDisplay];
+    while (receive(kDisplay, translated_, messages)) {
+        const auto since = Clock::now();
+        monitor_.display(messages);
+        account(counters.busy_ns, since);
+        counters.processed.fetch_add(1, std::memory_order_relaxed);
+        recycled_.push(std::move(messages));
+    }
+}
+
+}  // namespace translator
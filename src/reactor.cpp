@@ -1,50 +1,89 @@
 #include "reactor.h"
 
+#include "prng.h"
+#include "trace.h"
+
 namespace reactor {
 
-AnimalReactor::AnimalReactor(std::deque<pantomime::Video>& pantomime, std::deque<syllable::Noise>& sound,
-                             std::deque<animal::AnimalDecodingStub>& types, bool& reactive_cv)
-    : pantomime(pantomime),
-      sound(sound),
-      types(types),
+AnimalReactor::AnimalReactor(animal::FrameRing& frames, animal::AudioRing& audio,
+                             concurrency::ReadinessEvent& reactive_cv)
+    : frames(frames),
+      audio(audio),
       reactive_cv(reactive_cv),
       is_talking(true) {
-    animal_names[animal::Cat]    = "Кот";
-    animal_names[animal::Dog]    = "Пёс";
-    animal_names[animal::Parrot] = "Попугай";
-    animal_names[animal::Sheep]  = "Овца";
-    animal_names[animal::Cow]    = "Корова";
-    std::cout << "Зоопарк открывается!" << std::endl;
+    output::line() << "Зоопарк открывается!";
 }
 
 void AnimalReactor::startTalking() {
-    std::cout << "Животные начинают разговаривать!" << std::endl;
-    std::srand(std::time({}));
+    TRACE_SCOPE("AnimalReactor::startTalking");
+    output::line() << "Животные начинают разговаривать!";
+    prng::Xoshiro256& generator = prng::local();
     {
         std::unique_lock lock(mu_);
-        double rand    = ((double)std::rand() / (RAND_MAX));
-        size_t timeout = std::floor((rand * (kMaxSecond - kMinSecond) + kMinSecond) * kSecondScaller);
-        std::cout << "Сейчас животные устали, они подождут " << timeout << " мс прежде чем говорить снова" << std::endl;
+        size_t timeout = std::floor(generator.uniform(kMinSecond, kMaxSecond) * kSecondScaller);
+        output::line() << "Сейчас животные устали, они подождут " << timeout << " мс прежде чем говорить снова";
         cv_.wait_for(lock, std::chrono::milliseconds(timeout));
     }
-    std::cout << "Животные начинают активно разговаривать!" << std::endl;
-    size_t animal_count = std::rand() % kMaxAnimal + 1;
-    pantomime::Video video;
-    syllable::Noise noise;
-    animal::AnimalDecodingStub animal_type;
-    std::cout << "На беседу пришли:" << std::endl;
+    output::line() << "Животные начинают активно разговаривать!";
+    size_t animal_count = generator.below(kMaxAnimal) + 1;
+    animal::Frame frame;
+    output::line() << "На беседу пришли:";
     for (size_t iter = 0; iter < animal_count; iter++) {
         animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
-        std::cout << "\t" << iter << ". " << animal_names[animal.animal_type] << std::endl;
-        video.figures.push_back(animal.animal.body);
-        noise.noises.push_back(animal.animal.sound);
-        animal_type.types.push_back(animal.animal_type);
+        output::line() << "\t" << iter << ". " << animal_names[animal.animal_type];
+        frame.video.figures.push_back(animal.animal.body);
+        frame.noise.noises.push_back(animal.animal.sound);
+        frame.types.types.push_back(animal.animal_type);
+    }
+    // Снимаем беседу стереокамерой и измеряем расстояние дальномером
+    frame.distance = animal::random::renderVideo(frame.video, pantomime::kFrameWidth, pantomime::kFrameHeight);
+    // Звук беседы поступает в поток микрофона следом за кадром, кадр хранит только его положение в потоке
+    frame.noise.sample_rate  = syllable::kDefaultSampleRate;
+    frame.noise.sample_begin = audio.written();
+    frame.noise.sample_count = animal::random::noiseLength(frame.noise, frame.noise.sample_rate);
+    const syllable::Noise noise = frame.noise;
+    if (recorder.isOpen()) {
+        const std::chrono::duration<double> timestamp = std::chrono::steady_clock::now() - record_start;
+        recorder.beginFrame(frame, timestamp.count());
+    }
+    // Кадр публикуется целиком, поэтому видео, звук и типы животных не могут разойтись
+    if (!frames.push(std::move(frame)))
+        output::line() << "Датчики не успевают обрабатывать беседы, кадр отброшен";
+    reactive_cv.notify();
+    // Записываем звук беседы фрагментами так, как его слышат микрофоны; датчики разбирают его по мере поступления
+    TRACE_SCOPE("AnimalReactor::writeNoise");
+    for (size_t offset = 0; offset < noise.sample_count; offset += audio_chunk.size()) {
+        const std::span<float> chunk(audio_chunk.data(), std::min(audio_chunk.size(), noise.sample_count - offset));
+        animal::random::renderNoise(noise, noise.sample_rate, offset, chunk);
+        if (recorder.isOpen())
+            recorder.writeSamples(chunk);
+        if (!audio.write(chunk))
+            break;
+    }
+    if (recorder.isOpen())
+        recorder.endFrame();
+    if (!audio.closed())
+        output::line() << "Беседа окончена, можно начинать переводить";
+}
+
+bool AnimalReactor::startRecording(const std::string& path) {
+    if (!recorder.open(path)) {
+        output::line() << "Не удалось создать файл записи " << path;
+        return false;
     }
-    pantomime.push_back(video);
-    sound.push_back(noise);
-    types.push_back(animal_type);
-    std::cout << "Беседа окончена, можно начинать переводить" << std::endl;
-    reactive_cv = true;
+    record_start = std::chrono::steady_clock::now();
+    output::line() << "Начинаем запись бесед в " << path;
+    return true;
+}
+
+void AnimalReactor::stopRecording() {
+    if (!recorder.isOpen())
+        return;
+    const size_t frame_count = recorder.frameCount();
+    if (recorder.close())
+        output::line() << "Запись окончена, записано бесед: " << frame_count;
+    else
+        output::line() << "Запись окончена с ошибкой, файл может быть поврежден";
 }
 
 }  // namespace reactor
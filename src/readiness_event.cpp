@@ -0,0 +1,63 @@
+#include "readiness_event.h"
+
+#include <cstdint>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace concurrency {
+
+ReadinessEvent::ReadinessEvent() {
+#ifdef __linux__
+    fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+ReadinessEvent::~ReadinessEvent() {
+#ifdef __linux__
+    if (fd_ >= 0)
+        close(fd_);
+#endif
+}
+
+void ReadinessEvent::notify() {
+    {
+        std::lock_guard lock(mu_);
+        signaled_ = true;
+    }
+    cv_.notify_all();
+#ifdef __linux__
+    if (fd_ >= 0) {
+        uint64_t value = 1;
+        // Счетчик eventfd может только переполниться, что для флага готовности не важно
+        [[maybe_unused]] ssize_t written = write(fd_, &value, sizeof(value));
+    }
+#endif
+}
+
+bool ReadinessEvent::waitUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock lock(mu_);
+    if (!cv_.wait_until(lock, deadline, [this] { return signaled_; }))
+        return false;
+    signaled_ = false;
+    drainFd();
+    return true;
+}
+
+void ReadinessEvent::consume() {
+    std::lock_guard lock(mu_);
+    signaled_ = false;
+    drainFd();
+}
+
+void ReadinessEvent::drainFd() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        uint64_t value;
+        [[maybe_unused]] ssize_t got = read(fd_, &value, sizeof(value));
+    }
+#endif
+}
+
+}  // namespace concurrency
@@ -0,0 +1,227 @@
+#include "session.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace session {
+
+bool SessionWriter::open(const std::string& path) {
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+        return false;
+    // Заголовок дописывается при закрытии, когда известны количество кадров и положение индекса
+    const FileHeader header = {};
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+    index_.clear();
+    in_frame_ = false;
+    return file_.good();
+}
+
+bool SessionWriter::beginFrame(const animal::Frame& frame, double timestamp) {
+    if (!file_.is_open() || in_frame_)
+        return false;
+    const FrameHeader header = {
+        .timestamp    = timestamp,
+        .distance     = frame.distance,
+        .figure_count = (uint32_t)frame.video.figures.size(),
+        .sound_count  = (uint32_t)frame.noise.noises.size(),
+        .type_count   = (uint32_t)frame.types.types.size(),
+        .sample_rate  = frame.noise.sample_rate,
+        .width        = frame.video.disparity.empty() ? 0 : frame.video.width,
+        .height       = frame.video.disparity.empty() ? 0 : frame.video.height,
+        .sample_count = frame.noise.sample_count,
+    };
+    // Фигуры и звуки копируются по полям поверх обнуленной памяти, чтобы байты выравнивания структур не несли
+    // случайных значений и одинаковые сеансы давали одинаковые файлы
+    figures_.resize(frame.video.figures.size());
+    std::memset(figures_.data(), 0, figures_.size() * sizeof(pantomime::Pantomime));
+    for (size_t iter = 0; iter < figures_.size(); iter++) {
+        const pantomime::Pantomime& figure = frame.video.figures[iter];
+        figures_[iter].facial              = figure.facial;
+        figures_[iter].body                = figure.body;
+        figures_[iter].gestures            = figure.gestures;
+        figures_[iter].size                = figure.size;
+    }
+    sounds_.resize(frame.noise.noises.size());
+    std::memset(sounds_.data(), 0, sounds_.size() * sizeof(syllable::Sound));
+    for (size_t iter = 0; iter < sounds_.size(); iter++) {
+        const syllable::Sound& sound = frame.noise.noises[iter];
+        sounds_[iter].larinx         = sound.larinx;
+        sounds_[iter].throat         = sound.throat;
+        sounds_[iter].frequency      = sound.frequency;
+        sounds_[iter].volume         = sound.volume;
+        sounds_[iter].duration       = sound.duration;
+    }
+    index_.push_back(offset_);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ += sizeof(header);
+    writeArray(std::span<const pantomime::Pantomime>(figures_));
+    writeArray(std::span<const syllable::Sound>(sounds_));
+    writeArray(std::span<const animal::AnimalType>(frame.types.types));
+    writeArray(std::span<const uint8_t>(frame.video.disparity).first((size_t)header.width * header.height));
+    pending_samples_ = header.sample_count;
+    in_frame_        = true;
+    return file_.good();
+}
+
+bool SessionWriter::writeSamples(std::span<const float> samples) {
+    if (!in_frame_ || samples.size() > pending_samples_)
+        return false;
+    file_.write(reinterpret_cast<const char*>(samples.data()), samples.size_bytes());
+    offset_ += samples.size_bytes();
+    pending_samples_ -= samples.size();
+    return file_.good();
+}
+
+bool SessionWriter::endFrame() {
+    if (!in_frame_)
+        return false;
+    // Недостающий звук (например, при прерванной записи) дополняется тишиной, чтобы запись кадра была целой
+    static constexpr float kSilence[256] = {};
+    while (pending_samples_ > 0) writeSamples(std::span(kSilence, std::min<uint64_t>(pending_samples_, 256)));
+    pad();
+    in_frame_ = false;
+    return file_.good();
+}
+
+bool SessionWriter::close() {
+    if (!file_.is_open())
+        return true;
+    if (in_frame_)
+        endFrame();
+    FileHeader header = {
+        .version        = kVersion,
+        .header_size    = sizeof(FileHeader),
+        .frame_count    = index_.size(),
+        .index_offset   = offset_,
+        .pantomime_size = sizeof(pantomime::Pantomime),
+        .sound_size     = sizeof(syllable::Sound),
+    };
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    file_.write(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(uint64_t));
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const bool good = file_.good();
+    file_.close();
+    return good;
+}
+
+void SessionWriter::pad() {
+    static constexpr char kZeros[kAlignment] = {};
+    const size_t padding                     = (kAlignment - offset_ % kAlignment) % kAlignment;
+    file_.write(kZeros, padding);
+    offset_ += padding;
+}
+
+bool SessionReader::open(const std::string& path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(FileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение остается действительным после закрытия дескриптора
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = info.st_size;
+    madvise(data, size_, MADV_SEQUENTIAL);
+
+    const auto* header = reinterpret_cast<const FileHeader*>(data_);
+    const bool valid   = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 && header->version == kVersion &&
+                       header->header_size == sizeof(FileHeader) &&
+                       header->pantomime_size == sizeof(pantomime::Pantomime) &&
+                       header->sound_size == sizeof(syllable::Sound) && header->index_offset % kAlignment == 0 &&
+                       header->index_offset <= size_ &&
+                       header->frame_count <= (size_ - header->index_offset) / sizeof(uint64_t);
+    if (!valid) {
+        close();
+        return false;
+    }
+    const auto* index = reinterpret_cast<const uint64_t*>(data_ + header->index_offset);
+    frames_.resize(header->frame_count);
+    for (size_t iter = 0; iter < frames_.size(); iter++) {
+        if (!parseFrame(index[iter], frames_[iter])) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionReader::close() {
+    if (data_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    frames_.clear();
+}
+
+bool SessionReader::parseFrame(uint64_t offset, FrameView& frame) const {
+    if (offset % kAlignment != 0 || offset > size_ || size_ - offset < sizeof(FrameHeader))
+        return false;
+    const auto* header = reinterpret_cast<const FrameHeader*>(data_ + offset);
+    offset += sizeof(FrameHeader);
+    // Секции следуют друг за другом с выравниванием; каждая проверяется на выход за пределы файла
+    auto section = [this, &offset](uint64_t count, size_t element_size) -> const uint8_t* {
+        if (count > (size_ - offset) / element_size)
+            return nullptr;
+        const uint8_t* begin = data_ + offset;
+        offset += count * element_size;
+        offset += (kAlignment - offset % kAlignment) % kAlignment;
+        offset = std::min<uint64_t>(offset, size_);
+        return begin;
+    };
+    const uint8_t* figures   = section(header->figure_count, sizeof(pantomime::Pantomime));
+    const uint8_t* noises    = figures ? section(header->sound_count, sizeof(syllable::Sound)) : nullptr;
+    const uint8_t* types     = noises ? section(header->type_count, sizeof(animal::AnimalType)) : nullptr;
+    const uint8_t* disparity = types ? section((uint64_t)header->width * header->height, 1) : nullptr;
+    const uint8_t* samples   = disparity ? section(header->sample_count, sizeof(float)) : nullptr;
+    if (!samples)
+        return false;
+    frame = (FrameView){
+        .timestamp = header->timestamp,
+        .distance  = header->distance,
+        .video     = {.figures   = {reinterpret_cast<const pantomime::Pantomime*>(figures), header->figure_count},
+                      .disparity = {disparity, (size_t)header->width * header->height},
+                      .width     = header->width,
+                      .height    = header->height},
+        .noise     = {.noises      = {reinterpret_cast<const syllable::Sound*>(noises), header->sound_count},
+                      .samples     = {reinterpret_cast<const float*>(samples), header->sample_count},
+                      .sample_rate = header->sample_rate},
+        .types     = {reinterpret_cast<const animal::AnimalType*>(types), header->type_count},
+    };
+    return validFrame(frame);
+}
+
+bool SessionReader::validFrame(const FrameView& frame) {
+    if (!std::isfinite(frame.timestamp) || !std::isfinite(frame.distance) || frame.distance < 0)
+        return false;
+    for (const pantomime::Pantomime& figure : frame.video.figures) {
+        if ((unsigned)figure.facial >= pantomime::MaxFacialExpression ||
+            (unsigned)figure.body >= pantomime::MaxBodyPosition || (unsigned)figure.gestures >= pantomime::MaxGestures)
+            return false;
+    }
+    for (const syllable::Sound& sound : frame.noise.noises) {
+        if ((unsigned)sound.larinx >= syllable::MaxLarynxSound || (unsigned)sound.throat >= syllable::MaxThroatSound ||
+            !std::isfinite(sound.frequency) || sound.frequency < 0 || !std::isfinite(sound.duration) ||
+            sound.duration < 0)
+            return false;
+    }
+    return std::all_of(frame.types.begin(), frame.types.end(),
+                       [](animal::AnimalType type) { return (unsigned)type < animal::MaxAnimalType; });
+}
+
+}  // namespace session
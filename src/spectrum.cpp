@@ -0,0 +1,366 @@
+#include "spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPECTRUM_X86 1
+#endif
+
+namespace spectrum {
+
+namespace {
+
+#ifdef SPECTRUM_X86
+
+/// @brief Этапы преобразования с блоками не короче 8 отсчетов: бабочки по четыре комплексных отсчета
+__attribute__((target("avx2,fma"))) void butterfliesAvx2(std::complex<float>* data, size_t size,
+                                                          const std::complex<float>* stage_twiddles) {
+    for (size_t half = 4; half < size; half <<= 1) {
+        const float* twiddles = reinterpret_cast<const float*>(stage_twiddles + half - 4);
+        for (size_t block = 0; block < size; block += 2 * half) {
+            float* even = reinterpret_cast<float*>(data + block);
+            float* odd  = reinterpret_cast<float*>(data + block + half);
+            for (size_t iter = 0; iter < 2 * half; iter += 8) {
+                const __m256 twiddle = _mm256_loadu_ps(twiddles + iter);
+                const __m256 value   = _mm256_loadu_ps(odd + iter);
+                // (a + bi)(c + di): вещественные части a*c - b*d в четных дорожках, мнимые b*c + a*d в нечетных
+                const __m256 swapped = _mm256_permute_ps(value, 0xB1);
+                const __m256 product = _mm256_fmaddsub_ps(value, _mm256_moveldup_ps(twiddle),
+                                                          _mm256_mul_ps(swapped, _mm256_movehdup_ps(twiddle)));
+                const __m256 base    = _mm256_loadu_ps(even + iter);
+                _mm256_storeu_ps(odd + iter, _mm256_sub_ps(base, product));
+                _mm256_storeu_ps(even + iter, _mm256_add_ps(base, product));
+            }
+        }
+    }
+}
+
+/// @brief Наложение окна на отсчеты с записью в комплексный буфер (мнимые части обнуляются)
+__attribute__((target("avx2"))) void windowAvx2(const float* samples, const float* window, size_t count,
+                                                 std::complex<float>* buffer) {
+    constexpr size_t kLanes = 8;
+    const __m256 zero       = _mm256_setzero_ps();
+    float* out              = reinterpret_cast<float*>(buffer);
+    size_t iter             = 0;
+    for (; iter + kLanes <= count; iter += kLanes) {
+        const __m256 value = _mm256_mul_ps(_mm256_loadu_ps(samples + iter), _mm256_loadu_ps(window + iter));
+        // Распаковка чередует значения с нулями внутри 128-битных половин, перестановка половин восстанавливает порядок
+        const __m256 low  = _mm256_unpacklo_ps(value, zero);
+        const __m256 high = _mm256_unpackhi_ps(value, zero);
+        _mm256_storeu_ps(out + 2 * iter, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(out + 2 * iter + kLanes, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+    for (; iter < count; iter++) buffer[iter] = samples[iter] * window[iter];
+}
+
+/// @brief Мощность (квадрат модуля) комплексных отсчетов
+__attribute__((target("avx2"))) void powerAvx2(const std::complex<float>* spectrum, size_t count, float* power) {
+    constexpr size_t kLanes = 8;
+    const float* in         = reinterpret_cast<const float*>(spectrum);
+    size_t iter             = 0;
+    for (; iter + kLanes <= count; iter += kLanes) {
+        const __m256 first  = _mm256_loadu_ps(in + 2 * iter);
+        const __m256 second = _mm256_loadu_ps(in + 2 * iter + kLanes);
+        // Попарное сложение работает внутри 128-битных половин, поэтому результат переставляется по 64 бита
+        const __m256 sum = _mm256_hadd_ps(_mm256_mul_ps(first, first), _mm256_mul_ps(second, second));
+        _mm256_storeu_ps(power + iter,
+                         _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8)));
+    }
+    for (; iter < count; iter++) power[iter] = std::norm(spectrum[iter]);
+}
+
+#endif
+
+}  // namespace
+
+FftPlan::FftPlan(size_t size) : size_(size), bit_reverse_(size), twiddles_(size / 2) {
+    if (size < 2 || (size & (size - 1)) != 0)
+        throw std::invalid_argument("FftPlan size must be a power of two");
+    size_t bits = 0;
+    while ((size_t{1} << bits) < size) bits++;
+    for (size_t iter = 0; iter < size; iter++) {
+        uint32_t reversed = 0;
+        for (size_t bit = 0; bit < bits; bit++) reversed |= ((iter >> bit) & 1) << (bits - 1 - bit);
+        bit_reverse_[iter] = reversed;
+    }
+    for (size_t iter = 0; iter < size / 2; iter++) {
+        const double angle = -2 * std::numbers::pi * iter / size;
+        twiddles_[iter]    = std::complex<float>(std::cos(angle), std::sin(angle));
+    }
+    for (size_t half = 4; half < size; half <<= 1) {
+        for (size_t iter = 0; iter < half; iter++) stage_twiddles_.push_back(twiddles_[iter * (size / half / 2)]);
+    }
+}
+
+void FftPlan::forward(std::span<std::complex<float>> data, bool vectorized) const {
+    for (size_t iter = 0; iter < size_; iter++) {
+        if (iter < bit_reverse_[iter])
+            std::swap(data[iter], data[bit_reverse_[iter]]);
+    }
+    // Векторные бабочки обрабатывают этапы с блоками от 8 отсчетов, первые два этапа выполняются скалярно
+    const size_t last_length = vectorized ? std::min<size_t>(size_, 4) : size_;
+    for (size_t length = 2; length <= last_length; length <<= 1) {
+        const size_t half   = length / 2;
+        const size_t stride = size_ / length;
+        for (size_t block = 0; block < size_; block += length) {
+            for (size_t iter = 0; iter < half; iter++) {
+                const std::complex<float> odd = data[block + iter + half] * twiddles_[iter * stride];
+                data[block + iter + half]     = data[block + iter] - odd;
+                data[block + iter] += odd;
+            }
+        }
+    }
+#ifdef SPECTRUM_X86
+    if (vectorized)
+        butterfliesAvx2(data.data(), size_, stage_twiddles_.data());
+#endif
+}
+
+void CarrierTracker::reset(double frame_seconds, float tolerance, size_t max_gap) {
+    tracks_.clear();
+    frame_seconds_ = frame_seconds;
+    tolerance_     = tolerance;
+    max_gap_       = max_gap;
+}
+
+void CarrierTracker::update(std::span<const Peak> peaks, size_t frame, std::vector<syllable::Sound>& finished) {
+    const size_t continued = tracks_.size();
+    for (const Peak& peak : peaks) {
+        // Продолжаем ближайшую по частоте несущую, еще не продолженную в этом кадре
+        Track* nearest = nullptr;
+        for (size_t iter = 0; iter < continued; iter++) {
+            Track& track = tracks_[iter];
+            if (track.last_frame == frame || std::abs(track.last_frequency - peak.frequency) > tolerance_)
+                continue;
+            if (!nearest ||
+                std::abs(track.last_frequency - peak.frequency) < std::abs(nearest->last_frequency - peak.frequency))
+                nearest = &track;
+        }
+        if (!nearest) {
+            tracks_.push_back((Track){.frequency_sum  = peak.frequency,
+                                      .level          = peak.level,
+                                      .last_frequency = peak.frequency,
+                                      .first_frame    = frame,
+                                      .last_frame     = frame,
+                                      .frames         = 1});
+            continue;
+        }
+        nearest->frequency_sum += peak.frequency;
+        nearest->level          = std::max(nearest->level, peak.level);
+        nearest->last_frequency = peak.frequency;
+        nearest->last_frame     = frame;
+        nearest->frames++;
+    }
+    // Завершаем несущие, которые слишком долго не продолжались
+    auto ended = std::remove_if(tracks_.begin(), tracks_.end(), [this, frame, &finished](const Track& track) {
+        if (frame - track.last_frame <= max_gap_)
+            return false;
+        finished.push_back(finish(track));
+        return true;
+    });
+    tracks_.erase(ended, tracks_.end());
+}
+
+void CarrierTracker::flush(std::vector<syllable::Sound>& finished) {
+    for (const Track& track : tracks_) finished.push_back(finish(track));
+    tracks_.clear();
+}
+
+syllable::Sound CarrierTracker::finish(const Track& track) const {
+    // Вид звука по спектру не определяется, его восстанавливают следующие стадии обработки
+    return (syllable::Sound){.larinx    = syllable::Purring,
+                             .throat    = syllable::None,
+                             .frequency = track.frequency_sum / track.frames,
+                             .volume    = (int)std::lround(track.level),
+                             .duration  = (track.last_frame - track.first_frame + 1) * frame_seconds_};
+}
+
+SpectralAnalyzer::SpectralAnalyzer(size_t frame_size, size_t hop)
+    : plan_(frame_size),
+      hop_(hop),
+      window_(frame_size),
+      buffer_(frame_size),
+      level_(frame_size / 2 + 1) {
+    // Четырехчленное окно Блэкмана-Харриса: боковые лепестки ниже -92 дБ, что позволяет различать тихие звуки
+    // рядом с громкими
+    constexpr double kA0 = 0.35875, kA1 = 0.48829, kA2 = 0.14128, kA3 = 0.01168;
+    window_sum_ = 0;
+    for (size_t iter = 0; iter < frame_size; iter++) {
+        const double phase = 2 * std::numbers::pi * iter / (frame_size - 1);
+        window_[iter] = kA0 - kA1 * std::cos(phase) + kA2 * std::cos(2 * phase) - kA3 * std::cos(3 * phase);
+        window_sum_ += window_[iter];
+    }
+}
+
+std::span<const Peak> SpectralAnalyzer::findPeaks(std::span<const float> head, std::span<const float> tail,
+                                                  unsigned sample_rate) {
+    const size_t size = plan_.size();
+    // Наложение окна совмещено с копированием в рабочий буфер преобразования
+    const size_t head_size = std::min(head.size(), size);
+    const size_t tail_size = std::min(tail.size(), size - head_size);
+    const float scale      = 2.0f / window_sum_;
+    float max_level        = -INFINITY;
+#ifdef SPECTRUM_X86
+    if (vectorized_) {
+        windowAvx2(head.data(), window_.data(), head_size, buffer_.data());
+        windowAvx2(tail.data(), window_.data() + head_size, tail_size, buffer_.data() + head_size);
+        std::fill(buffer_.begin() + head_size + tail_size, buffer_.end(), std::complex<float>());
+        plan_.forward(buffer_, true);
+        // Уровень считается по мощности без извлечения корня: 20 lg(a) = 10 lg(a^2)
+        powerAvx2(buffer_.data(), level_.size(), level_.data());
+        const float power_scale = scale * scale;
+        for (float& level : level_) {
+            level     = 10 * std::log10(std::max(level * power_scale, 1e-24f)) + syllable::kFullScaleVolume;
+            max_level = std::max(max_level, level);
+        }
+        return collectPeaks(max_level, sample_rate);
+    }
+#endif
+    for (size_t iter = 0; iter < head_size; iter++) buffer_[iter] = head[iter] * window_[iter];
+    for (size_t iter = 0; iter < tail_size; iter++)
+        buffer_[head_size + iter] = tail[iter] * window_[head_size + iter];
+    std::fill(buffer_.begin() + head_size + tail_size, buffer_.end(), std::complex<float>());
+    plan_.forward(buffer_);
+
+    // Уровень каждого отсчета спектра в единицах громкости: амплитуда синусоиды восстанавливается по усилению окна
+    for (size_t bin = 0; bin < level_.size(); bin++) {
+        const float amplitude = std::abs(buffer_[bin]) * scale;
+        level_[bin]           = 20 * std::log10(std::max(amplitude, 1e-12f)) + syllable::kFullScaleVolume;
+        max_level             = std::max(max_level, level_[bin]);
+    }
+    return collectPeaks(max_level, sample_rate);
+}
+
+std::span<const Peak> SpectralAnalyzer::collectPeaks(float max_level, unsigned sample_rate) {
+    peaks_.clear();
+    const float threshold = std::max(kMinLevel, max_level - kDynamicRange);
+    const double bin_hz   = resolution(sample_rate);
+    for (size_t bin = kPeakRadius; bin + kPeakRadius < level_.size(); bin++) {
+        const float level = level_[bin];
+        if (level < threshold)
+            continue;
+        bool is_peak = true;
+        for (size_t near = bin - kPeakRadius; near <= bin + kPeakRadius && is_peak; near++)
+            is_peak = near == bin || level_[near] < level || (level_[near] == level && near > bin);
+        if (!is_peak)
+            continue;
+        // Параболическая интерполяция по соседним отсчетам уточняет частоту и уровень пика
+        const float left   = level_[bin - 1];
+        const float right  = level_[bin + 1];
+        const float denom  = left - 2 * level + right;
+        const float offset = denom != 0 ? 0.5f * (left - right) / denom : 0;
+        peaks_.push_back((Peak){.frequency = static_cast<float>((bin + offset) * bin_hz),
+                                .level     = level - 0.25f * (left - right) * offset});
+    }
+    return peaks_;
+}
+
+StreamingAnalyzer::StreamingAnalyzer(size_t frame_size, size_t hop) : analyzer_(frame_size, hop) {}
+
+void StreamingAnalyzer::begin(unsigned sample_rate, size_t length, execution::Backend backend,
+                              concurrency::TaskPool* pool) {
+    sample_rate_ = sample_rate;
+    remaining_   = length;
+    frame_       = 0;
+    backend_     = backend == execution::kThreaded && !pool ? execution::kSimd : backend;
+    pool_        = pool;
+    analyzer_.setVectorized(backend_ != execution::kScalar);
+    tracker_.reset((double)analyzer_.hop() / sample_rate, tolerance(), SpectralAnalyzer::kTrackGap);
+}
+
+bool StreamingAnalyzer::feed(animal::AudioRing& ring, std::vector<syllable::Sound>& finished) {
+    if (backend_ == execution::kThreaded) {
+        const auto available = ring.peek(ring.size());
+        const size_t step    = planFrames(available.head, available.tail);
+        analyzeFrames(finished);
+        ring.consume(step);
+        return remaining_ == 0;
+    }
+    while (remaining_ > 0) {
+        // Последние кадры беседы короче размера кадра и дополняются нулями
+        const size_t frame_size = pending();
+        if (ring.size() < frame_size)
+            return false;
+        const auto frame = ring.peek(frame_size);
+        tracker_.update(analyzer_.findPeaks(frame.head, frame.tail, sample_rate_), frame_++, finished);
+        const size_t step = std::min(analyzer_.hop(), remaining_);
+        ring.consume(step);
+        remaining_ -= step;
+        if (remaining_ == 0)
+            tracker_.flush(finished);
+    }
+    return true;
+}
+
+bool StreamingAnalyzer::feed(std::span<const float> samples, std::vector<syllable::Sound>& finished) {
+    if (backend_ == execution::kThreaded) {
+        planFrames(samples, {});
+        analyzeFrames(finished);
+        return remaining_ == 0;
+    }
+    while (remaining_ > 0) {
+        const size_t frame_size = pending();
+        if (samples.size() < frame_size)
+            return false;
+        tracker_.update(analyzer_.findPeaks(samples.first(frame_size), {}, sample_rate_), frame_++, finished);
+        const size_t step = std::min(analyzer_.hop(), remaining_);
+        samples           = samples.subspan(step);
+        remaining_ -= step;
+        if (remaining_ == 0)
+            tracker_.flush(finished);
+    }
+    return true;
+}
+
+size_t StreamingAnalyzer::planFrames(std::span<const float> head, std::span<const float> tail) {
+    frames_.clear();
+    const size_t available = head.size() + tail.size();
+    size_t offset = 0, remaining = remaining_;
+    while (remaining > 0) {
+        const size_t frame_size = std::min(analyzer_.frameSize(), remaining);
+        if (available - offset < frame_size)
+            break;
+        const size_t step = std::min(analyzer_.hop(), remaining);
+        if (offset < head.size())
+            frames_.push_back((PendingFrame){.head = head.subspan(offset), .tail = tail, .step = step});
+        else
+            frames_.push_back((PendingFrame){.head = tail.subspan(offset - head.size()), .step = step});
+        offset += step;
+        remaining -= step;
+    }
+    return offset;
+}
+
+void StreamingAnalyzer::analyzeFrames(std::vector<syllable::Sound>& finished) {
+    const size_t count = frames_.size();
+    if (count == 0)
+        return;
+    // Каждая часть кадров анализируется своим анализатором, вызывающий поток тоже берет часть
+    const size_t parts = std::min(count, pool_->size() + 1);
+    const size_t grain = (count + parts - 1) / parts;
+    while (workers_.size() < parts) {
+        workers_.emplace_back(analyzer_.frameSize(), analyzer_.hop());
+        workers_.back().setVectorized(true);
+    }
+    if (frame_peaks_.size() < count)
+        frame_peaks_.resize(count);
+    pool_->parallelFor(count, grain, [this, grain](size_t begin, size_t end) {
+        SpectralAnalyzer& worker = workers_[begin / grain];
+        for (size_t iter = begin; iter < end; iter++) {
+            const auto peaks = worker.findPeaks(frames_[iter].head, frames_[iter].tail, sample_rate_);
+            frame_peaks_[iter].assign(peaks.begin(), peaks.end());
+        }
+    });
+    // Несущие отслеживаются последовательно, в порядке кадров
+    for (size_t iter = 0; iter < count; iter++) {
+        tracker_.update(frame_peaks_[iter], frame_++, finished);
+        remaining_ -= frames_[iter].step;
+    }
+    if (remaining_ == 0)
+        tracker_.flush(finished);
+}
+
+}  // namespace spectrum
@@ -0,0 +1,141 @@
+#include "task_pool.h"
+
+#include "latency.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace concurrency {
+
+thread_local TaskPool* TaskPool::current_pool_ = nullptr;
+thread_local size_t TaskPool::current_index_   = 0;
+
+TaskPool::TaskPool(size_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    queues_.reserve(threads);
+    for (size_t iter = 0; iter < threads; iter++) queues_.push_back(std::make_unique<WorkQueue>());
+    workers_.reserve(threads);
+    for (size_t iter = 0; iter < threads; iter++) workers_.emplace_back(&TaskPool::work, this, iter);
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard lock(sleep_mu_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void TaskPool::enqueue(Task task) {
+    // Задачи рабочего потока остаются в его очереди, внешние задачи распределяются по очередям по кругу
+    const size_t index = current_pool_ == this ? current_index_
+                                               : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    // Счетчик увеличивается до публикации задачи, чтобы взявший ее поток не увел его в отрицательную область
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(queues_[index]->mu);
+        queues_[index]->tasks.pushBack(std::move(task));
+    }
+    // Захват мьютекса сна гарантирует, что засыпающий поток либо увидит задачу, либо получит оповещение
+    { std::lock_guard lock(sleep_mu_); }
+    sleep_cv_.notify_one();
+}
+
+bool TaskPool::popLocal(size_t index, Task& task) {
+    WorkQueue& queue = *queues_[index];
+    std::lock_guard lock(queue.mu);
+    if (queue.tasks.empty())
+        return false;
+    task = queue.tasks.popBack();
+    return true;
+}
+
+bool TaskPool::steal(size_t thief, Task& task) {
+    for (size_t shift = 1; shift <= queues_.size(); shift++) {
+        WorkQueue& queue = *queues_[(thief + shift) % queues_.size()];
+        std::lock_guard lock(queue.mu);
+        if (queue.tasks.empty())
+            continue;
+        task = queue.tasks.popFront();
+        return true;
+    }
+    return false;
+}
+
+bool TaskPool::runPendingTask() {
+    if (pending_.load(std::memory_order_acquire) == 0)
+        return false;
+    Task task;
+    const bool own    = current_pool_ == this;
+    const size_t self = own ? current_index_ : next_queue_.load(std::memory_order_relaxed) % queues_.size();
+    if (!(own && popLocal(self, task)) && !steal(self, task))
+        return false;
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void TaskPool::runRange(size_t count, size_t grain, RangeBody body) {
+    grain = std::max<size_t>(grain, 1);
+    if (count <= grain || queues_.size() == 1) {
+        body.call(body.object, 0, count);
+        return;
+    }
+    const size_t chunks = (count + grain - 1) / grain;
+    // Описание диапазона и счетчик частей живут на стеке вызывающего потока. Последняя часть оповещает о завершении
+    // под мьютексом, а вызывающий поток проверяет счетчик только под ним же, поэтому он не вернется (и не разрушит
+    // счетчик), пока задача не закончит оповещение
+    struct Completion {
+        RangeBody body;
+        size_t count;
+        size_t grain;
+        std::mutex mu;
+        std::condition_variable cv;
+        size_t remaining;
+    } done{.body = body, .count = count, .grain = grain, .remaining = chunks - 1};
+    for (size_t chunk = 1; chunk < chunks; chunk++) {
+        // Задача захватывает только ссылку и номер части и умещается в std::function без выделения памяти
+        enqueue([&done, chunk] {
+            const size_t begin = chunk * done.grain;
+            done.body.call(done.body.object, begin, std::min(done.count, begin + done.grain));
+            std::lock_guard lock(done.mu);
+            if (--done.remaining == 0)
+                done.cv.notify_all();
+        });
+    }
+    // Первую часть обрабатывает вызывающий поток, затем помогает с остальными
+    body.call(body.object, 0, std::min(count, grain));
+    auto finished = [&done] {
+        std::lock_guard lock(done.mu);
+        return done.remaining == 0;
+    };
+    while (!finished()) {
+        if (!runPendingTask()) {
+            std::unique_lock lock(done.mu);
+            done.cv.wait(lock, [&done] { return done.remaining == 0; });
+        }
+    }
+}
+
+void TaskPool::work(size_t index) {
+    current_pool_  = this;
+    current_index_ = index;
+    trace::nameThread("пул " + std::to_string(index));
+    latency::attachThread();
+    Task task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock lock(sleep_mu_);
+        sleep_cv_.wait(lock, [this] { return stop_ || pending_.load(std::memory_order_acquire) > 0; });
+        if (stop_ && pending_.load(std::memory_order_acquire) == 0)
+            break;
+    }
+}
+
+}  // namespace concurrency
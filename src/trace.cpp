@@ -0,0 +1,195 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief Начало отсчета времени трассы
+const Clock::time_point epoch = Clock::now();
+
+/*!
+ * @brief Событие в кольцевом буфере потока
+ * Поля атомарны, так как выгрузка может читать ячейку, которую поток в этот момент перезаписывает;
+ * такие ячейки отбрасываются по позиции захвата (как в seqlock).
+ */
+struct Slot {
+    std::atomic<uint64_t> timestamp;  ///< Время события, нс от начала трассы; старший бит - окончание участка
+    std::atomic<const char*> name;
+};
+
+/// @brief Признак окончания участка в поле timestamp
+constexpr uint64_t kEndBit = 1ull << 63;
+
+/// @brief События одного потока
+struct ThreadEvents {
+    std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(kEventsPerThread);
+    /// @brief Количество захваченных ячеек: поток увеличивает его перед перезаписью ячейки
+    std::atomic<uint64_t> claimed{0};
+    /// @brief Количество записанных событий (изменяется только потоком-владельцем)
+    std::atomic<uint64_t> written{0};
+    /// @brief Позиция, с которой события попадают в трассу
+    std::atomic<uint64_t> start{0};
+    /// @brief Буфер занят работающим потоком; буфер завершившегося потока переходит следующему
+    std::atomic<bool> owned{true};
+    /// @brief Название потока (защищено блокировкой реестра)
+    std::string name;
+};
+
+/*!
+ * @brief Реестр буферов событий всех потоков
+ * Блокировка берется только при первом событии потока, при смене названия потока и при выгрузке.
+ */
+class Registry {
+public:
+    ThreadEvents* acquire() {
+        std::lock_guard lock(mu_);
+        for (auto& events : threads_) {
+            bool expected = false;
+            if (events->owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return events.get();
+        }
+        threads_.push_back(std::make_unique<ThreadEvents>());
+        threads_.back()->name = "поток " + std::to_string(threads_.size());
+        return threads_.back().get();
+    }
+
+    void rename(ThreadEvents* events, const std::string& name) {
+        std::lock_guard lock(mu_);
+        events->name = name;
+    }
+
+    /// @brief Отбрасывание записанных событий всех потоков
+    void clear() {
+        std::lock_guard lock(mu_);
+        for (auto& events : threads_) events->start.store(events->written.load(std::memory_order_acquire));
+    }
+
+    bool dump(const std::string& path);
+
+private:
+    std::mutex mu_;
+    std::vector<std::unique_ptr<ThreadEvents>> threads_;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/// @brief Буфер событий текущего потока; при завершении потока возвращается в реестр
+class Lease {
+public:
+    Lease() : events(registry().acquire()) {}
+
+    ~Lease() { events->owned.store(false, std::memory_order_release); }
+
+    ThreadEvents* const events;
+};
+
+ThreadEvents* local() {
+    thread_local Lease lease;
+    return lease.events;
+}
+
+/// @brief Запись строки в JSON с экранированием кавычек, обратной косой черты и управляющих символов
+void writeString(std::ofstream& file, std::string_view text) {
+    file << '"';
+    for (char symbol : text) {
+        if (symbol == '"' || symbol == '\\')
+            file << '\\' << symbol;
+        else if ((unsigned char)symbol < 0x20)
+            file << ' ';
+        else
+            file << symbol;
+    }
+    file << '"';
+}
+
+bool Registry::dump(const std::string& path) {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    std::lock_guard lock(mu_);
+    file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* separator = "\n";
+    for (size_t tid = 0; tid < threads_.size(); tid++) {
+        const ThreadEvents& events = *threads_[tid];
+        file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":";
+        writeString(file, events.name);
+        file << "}}";
+        separator = ",\n";
+
+        const uint64_t written = events.written.load(std::memory_order_acquire);
+        const uint64_t first   = std::max(events.start.load(std::memory_order_relaxed),
+                                          written > kEventsPerThread ? written - kEventsPerThread : 0);
+        // Копируем события, затем отбрасываем те, что поток успел перезаписать во время копирования
+        std::vector<std::pair<uint64_t, const char*>> copied;
+        copied.reserve(written - first);
+        for (uint64_t pos = first; pos < written; pos++) {
+            const Slot& slot = events.slots[pos % kEventsPerThread];
+            copied.emplace_back(slot.timestamp.load(std::memory_order_relaxed),
+                                slot.name.load(std::memory_order_relaxed));
+        }
+        // Событие pos перезаписано, если поток уже захватил ячейку pos + K
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = events.claimed.load(std::memory_order_relaxed);
+        const size_t skip      = claimed > first + kEventsPerThread
+                                     ? std::min<uint64_t>(copied.size(), claimed - first - kEventsPerThread)
+                                     : 0;
+        // Окончания участков, начало которых уже перезаписано, в трассу не попадают
+        size_t depth = 0;
+        for (size_t iter = skip; iter < copied.size(); iter++) {
+            const auto [timestamp, name] = copied[iter];
+            const bool end               = timestamp & kEndBit;
+            if (end && depth == 0)
+                continue;
+            depth += end ? -1 : 1;
+            file << ",\n{\"name\":";
+            writeString(file, name);
+            file << ",\"ph\":\"" << (end ? 'E' : 'B') << "\",\"ts\":" << (timestamp & ~kEndBit) / 1e3
+                 << ",\"pid\":1,\"tid\":" << tid << '}';
+        }
+    }
+    file << "\n]}\n";
+    return (bool)file;
+}
+
+}  // namespace
+
+void record(const char* name, Phase phase) {
+    ThreadEvents* events = local();
+    const uint64_t pos   = events->written.load(std::memory_order_relaxed);
+    const uint64_t now   = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+    Slot& slot           = events->slots[pos % kEventsPerThread];
+    events->claimed.store(pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp.store(now | (phase == kEnd ? kEndBit : 0), std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    events->written.store(pos + 1, std::memory_order_release);
+}
+
+void nameThread(const std::string& name) {
+    if constexpr (kCompiled)
+        registry().rename(local(), name);
+}
+
+void setRecording(bool value) {
+    if (value)
+        registry().clear();
+    recording.store(value, std::memory_order_relaxed);
+}
+
+bool dump(const std::string& path) { return registry().dump(path); }
+
+}  // namespace trace
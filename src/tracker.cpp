@@ -0,0 +1,89 @@
+#include "tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tracking {
+
+namespace {
+
+/// @brief Относительная разница положительных величин
+double relative(double first, double second) {
+    return std::abs(first - second) / std::max({std::abs(first), std::abs(second), 1.0});
+}
+
+}  // namespace
+
+double Tracker::distance(const Track& track, const pantomime::Pantomime& body, const syllable::Sound& sound) {
+    // Звук горла определяется видом животного, поэтому животные с разными звуками - разные животные
+    if (track.sound.throat != sound.throat)
+        return std::numeric_limits<double>::infinity();
+    return relative(track.body.size, body.size) / kSizeScale +
+           relative(track.sound.frequency, sound.frequency) / kFrequencyScale +
+           std::abs(track.sound.volume - sound.volume) / kVolumeScale +
+           (track.body.gestures != body.gestures ? kGesturePenalty : 0);
+}
+
+void Tracker::update(std::span<const pantomime::Pantomime> pantomime, std::span<const syllable::Sound> sound,
+                     std::vector<size_t>& slots) {
+    const size_t animal_count = pantomime.size();
+    stats_.frames.fetch_add(1, std::memory_order_relaxed);
+    // Допустимые пары животное - трек; память выделяется сразу под пары со всеми треками, которые умещаются
+    // в выделенную для треков память, поэтому список растет только вместе с ней
+    candidates_.clear();
+    candidates_.reserve(tracks_.capacity() * animal_count);
+    for (size_t slot = 0; slot < tracks_.size(); slot++) {
+        if (tracks_[slot].id == 0)
+            continue;
+        for (size_t animal = 0; animal < animal_count; animal++) {
+            const double value = distance(tracks_[slot], pantomime[animal], sound[animal]);
+            if (value <= kMaxDistance)
+                candidates_.push_back((Candidate){.distance = value, .animal = animal, .slot = slot});
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end(),
+              [](const Candidate& first, const Candidate& second) { return first.distance < second.distance; });
+    // Жадное сопоставление: ближайшие пары первыми
+    constexpr size_t kUnassigned = SIZE_MAX;
+    slots.assign(animal_count, kUnassigned);
+    taken_.assign(tracks_.size(), false);
+    for (const Candidate& candidate : candidates_) {
+        if (slots[candidate.animal] != kUnassigned || taken_[candidate.slot])
+            continue;
+        slots[candidate.animal] = candidate.slot;
+        taken_[candidate.slot]  = true;
+        stats_.matched.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Не найденные треки стареют и удаляются
+    for (size_t slot = 0; slot < tracks_.size(); slot++) {
+        Track& track = tracks_[slot];
+        if (track.id == 0 || taken_[slot] || ++track.missed <= kMaxMissed)
+            continue;
+        track.id = 0;
+        free_.push_back(slot);
+        stats_.lost.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Несопоставленные животные получают новые треки
+    for (size_t animal = 0; animal < animal_count; animal++) {
+        if (slots[animal] != kUnassigned)
+            continue;
+        if (free_.empty()) {
+            free_.push_back(tracks_.size());
+            tracks_.emplace_back();
+        }
+        slots[animal] = free_.back();
+        free_.pop_back();
+        tracks_[slots[animal]].id = next_id_++;
+        stats_.created.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Признаки треков обновляются по текущему кадру
+    for (size_t animal = 0; animal < animal_count; animal++) {
+        Track& track = tracks_[slots[animal]];
+        track.body   = pantomime[animal];
+        track.sound  = sound[animal];
+        track.missed = 0;
+    }
+}
+
+}  // namespace tracking
@@ -1,96 +1,413 @@
 #include "translator.h"
 
+#include "allocation_counter.h"
+#include "prng.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
 namespace translator {
 
 animal::PreparedData Sensor::prepareBatchOfData() {
+    TRACE_SCOPE("Sensor::prepareBatchOfData");
     // Ожидание пока получим минимальный набор данных для анализа
-    animal::PackedData packed_data = primary_sensor.waitAndPackData();
+    animal::PackedData packed_data;
+    {
+        TRACE_SCOPE("Sensor::collectData");
+        latency::Span collect(latency::kCollect);
+        packed_data = collectData();
+    }
     if (!packed_data.ready)
         return (animal::PreparedData){.ready = false};
+    return prepareData(packed_data);
+}
+
+animal::PreparedData Sensor::prepareData(animal::PackedData& packed_data) {
+    TRACE_SCOPE("Sensor::prepareData");
+    latency::Span span(latency::kPrepare);
     animal::PreparedData prepared_data;
     prepared_data.ready = true;
-    // Обрабатываем аудио-данные
-    prepared_data.sound = sound_formatter.devideCarrier(packed_data.noise);
-    // Обрабатываем видео-данные
-    prepared_data.pantomime = video_formatter.splitAndClassify(packed_data.video, packed_data.distance);
+    prepared_data.types = std::move(packed_data.types);
+    if (!parallel_formatting_) {
+        // Обрабатываем аудио-данные
+        prepared_data.sound = sound_formatter.devideCarrier(packed_data.noise);
+        // Обрабатываем видео-данные
+        prepared_data.pantomime = video_formatter.splitAndClassify(packed_data.video.view(), packed_data.distance,
+                                                                   std::move(packed_data.video.figures));
+        return prepared_data;
+    }
+    // Видео и звук независимы: аудио-данные обрабатываются в общем пуле, пока текущий поток обрабатывает видео
+    pool.invoke(
+        [this, &packed_data, &prepared_data] {
+            prepared_data.pantomime = video_formatter.splitAndClassify(packed_data.video.view(), packed_data.distance,
+                                                                       std::move(packed_data.video.figures));
+        },
+        [this, &packed_data, &prepared_data] {
+            prepared_data.sound = sound_formatter.devideCarrier(packed_data.noise);
+        });
     return prepared_data;
 }
 
-animal::PackedData Sensor::PrimarySensor::waitAndPackData() {
-    if (!cv_)
-        return (animal::PackedData){.ready = false};
-    std::cout << "Устройство ждет окончания беседы" << std::endl;
+void Sensor::prepareData(const session::FrameView& frame, animal::PreparedData& prepared_data) {
+    TRACE_SCOPE("Sensor::prepareData");
+    latency::Span span(latency::kPrepare);
+    // Буферы подготовленных данных проходят через разбор видео и звука и возвращаются обратно вместе с памятью
+    prepared_data.ready = true;
+    prepared_data.types.assign(frame.types.begin(), frame.types.end());
+    prepared_data.pantomime.assign(frame.video.figures.begin(), frame.video.figures.end());
+    if (!parallel_formatting_) {
+        prepared_data.sound = sound_formatter.devideCarrier(frame.noise, std::move(prepared_data.sound));
+        prepared_data.pantomime =
+            video_formatter.splitAndClassify(frame.video, frame.distance, std::move(prepared_data.pantomime));
+        return;
+    }
+    pool.invoke(
+        [this, &frame, &prepared_data] {
+            prepared_data.pantomime =
+                video_formatter.splitAndClassify(frame.video, frame.distance, std::move(prepared_data.pantomime));
+        },
+        [this, &frame, &prepared_data] {
+            prepared_data.sound = sound_formatter.devideCarrier(frame.noise, std::move(prepared_data.sound));
+        });
+}
+
+animal::PackedData Sensor::PrimarySensor::waitAndPackData(std::chrono::milliseconds timeout) {
     // Вместо реального ожидания поступления минимального кол-ва данных ожидаем оповещения от класса Животного
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    animal::Frame frame;
+    while (!frames.tryPop(frame)) {
+        // Событие взводится после публикации кадра, поэтому проверка очереди перед ожиданием не теряет сигналов
+        if (frames.ready().waitUntil(deadline))
+            continue;
+        if (frames.tryPop(frame))
+            break;
+        return (animal::PackedData){.ready = false};
+    }
+    return pack(frame);
+}
+
+animal::PackedData Sensor::PrimarySensor::tryPackData() {
+    animal::Frame frame;
+    if (!frames.tryPop(frame))
+        return (animal::PackedData){.ready = false};
+    return pack(frame);
+}
+
+animal::PackedData Sensor::PrimarySensor::pack(animal::Frame& frame) {
     // Создаем упакованные первичные данные с датчиков
     animal::PackedData packed_data;
-    packed_data.ready = true;
-    packed_data.video = pantomime.front();
-    pantomime.pop_front();
-    packed_data.noise = sound.front();
-    sound.pop_front();
-    packed_data.distance = (double)std::rand() / RAND_MAX;
+    packed_data.ready    = true;
+    packed_data.video    = std::move(frame.video);
+    packed_data.noise    = std::move(frame.noise);
+    packed_data.types    = std::move(frame.types.types);
+    packed_data.distance = frame.distance;
     // Передаем упакованные данные дальше
     return packed_data;
 }
 
-std::vector<pantomime::Pantomime> Sensor::VideoFormatter::splitAndClassify(pantomime::Video& video, double distance) {
+std::vector<pantomime::Pantomime> Sensor::VideoFormatter::splitAndClassify(const pantomime::VideoView& video,
+                                                                           double distance,
+                                                                           std::vector<pantomime::Pantomime> figures) {
+    TRACE_SCOPE("VideoFormatter::splitAndClassify");
+    latency::Span span(latency::kVideo);
     // Строим карту глубины по изображению
-    DeepMap deep_map = buildDeepMap(video, distance);
+    DeepMap deep_map = buildDeepMap(video, distance, backends.get(execution::kVideo), figures);
     // По карте глубины выделяем визуальные признаки различных сущностей на видео
     return getVisualIndication(deep_map);
 }
 
-Sensor::VideoFormatter::DeepMap Sensor::VideoFormatter::buildDeepMap(pantomime::Video& video, double distance) {
-    /// @todo Строим карту глубины
-    /// @todo Делаем поправку на расстояние
-    return (DeepMap){.pantomime = video.figures};
+Sensor::VideoFormatter::DeepMap Sensor::VideoFormatter::buildDeepMap(const pantomime::VideoView& video,
+                                                                      double distance, execution::Backend backend,
+                                                                      std::vector<pantomime::Pantomime>& figures) {
+    DeepMap deep_map = {.pantomime = std::move(figures)};
+    if (video.disparity.empty())
+        return deep_map;
+    // Строим карту глубины с поправкой на расстояние и разделяем ее на области
+    mapper.build(video, distance, backend);
+    deep_map.components = mapper.segment();
+    return deep_map;
 }
 
 std::vector<pantomime::Pantomime> Sensor::VideoFormatter::getVisualIndication(
     Sensor::VideoFormatter::DeepMap& deep_map) {
-    /// @todo Разделяем объекты на видео
-    /// @todo Получаем первичную визуальную информацию об объектах
-    return deep_map.pantomime;
+    const size_t figure_count = deep_map.pantomime.size();
+    if (deep_map.components.empty() || figure_count == 0)
+        return std::move(deep_map.pantomime);
+    // Фигуры расположены в столбцах кадра слева направо, каждой достается крупнейшая область ее столбца
+    matched.assign(figure_count, nullptr);
+    for (const auto& component : deep_map.components) {
+        const size_t figure = std::min(figure_count - 1, (size_t)(component.centerX() * figure_count / mapper.width()));
+        if (!matched[figure] || matched[figure]->area < component.area)
+            matched[figure] = &component;
+    }
+    // Размер фигуры измеряется по ее высоте на карте глубины
+    for (size_t iter = 0; iter < figure_count; iter++) {
+        if (matched[iter])
+            deep_map.pantomime[iter].size = std::lround(mapper.size(*matched[iter]));
+    }
+    return std::move(deep_map.pantomime);
 }
 
 std::vector<syllable::Sound> Sensor::SoundFormatter::devideCarrier(syllable::Noise& noise) {
-    // Разделяем звук на несущие
-    Carrier carrier = splitCarrier(noise);
-    // Обрабатываем несущие выделяя частоты и громкость
-    return buildCarrier(carrier);
-}
-
-Sensor::SoundFormatter::Carrier Sensor::SoundFormatter::splitCarrier(syllable::Noise& noise) {
-    /// @todo Проводим частотный анализ звука
-    /// @todo На основе анализа делим звук на части
-    return (Carrier){.sound = noise.noises};
-}
-
-std::vector<syllable::Sound> Sensor::SoundFormatter::buildCarrier(Sensor::SoundFormatter::Carrier carrier) {
-    /// @todo Определяем среднюю частоту несущей
-    /// @todo определяем среднюю громкость звука
-    return carrier.sound;
-}
-
-std::vector<animal::DecodedAnimalCharacteristic> Translator::translate(animal::PreparedData& prepared_data,
-                                                                       std::vector<animal::AnimalType> types) {
-    std::vector<animal::DecodedAnimalCharacteristic> decoded;
-    std::cout << "Начинаем перевод..." << std::endl;
-    // Проходимся по каждому существу в списке и составляем для него перевод
-    for (size_t iter = 0; iter < prepared_data.pantomime.size(); iter++) {
-        // Выделяем языковыве сигналы
-        animal::DecodedAnimalCharacteristic animal =
-            predictAnimalCharacteristic(prepared_data.pantomime, prepared_data.sound, types, iter);
-        // Пытаемся понять, какое настроение и какие потребности у животного
-        Need need = translateNeed(animal);
-        // Подготовливаем сообщение перевода
-        animal.message = predictMessage(animal, need);
-        decoded.push_back(animal);
+    TRACE_SCOPE("SoundFormatter::devideCarrier");
+    latency::Span span(latency::kAudio);
+    // Звуки переходят в разбор без копирования, буферы разбора переиспользуются между беседами
+    carrier.sound = std::move(noise.noises);
+    carrier.measured.clear();
+    if (noise.sample_count == 0 || noise.sample_rate == 0 || !seekCarrier(noise.sample_begin))
+        return std::move(carrier.sound);
+    carrier.refined.assign(carrier.sound.size(), false);
+    analyzer.begin(noise.sample_rate, noise.sample_count, backends.get(execution::kAudio), &pool);
+    carrier.tolerance = analyzer.tolerance();
+    // Разделяем звук на несущие по мере поступления и сразу уточняем по ним частоты и громкость
+    while (splitCarrier(carrier)) buildCarrier(carrier);
+    buildCarrier(carrier);
+    return std::move(carrier.sound);
+}
+
+std::vector<syllable::Sound> Sensor::SoundFormatter::devideCarrier(const syllable::NoiseView& noise,
+                                                                   std::vector<syllable::Sound> sound) {
+    TRACE_SCOPE("SoundFormatter::devideCarrier");
+    latency::Span span(latency::kAudio);
+    carrier.sound = std::move(sound);
+    carrier.sound.assign(noise.noises.begin(), noise.noises.end());
+    carrier.measured.clear();
+    if (noise.samples.empty() || noise.sample_rate == 0)
+        return std::move(carrier.sound);
+    carrier.refined.assign(carrier.sound.size(), false);
+    analyzer.begin(noise.sample_rate, noise.samples.size(), backends.get(execution::kAudio), &pool);
+    carrier.tolerance = analyzer.tolerance();
+    // Звук записан целиком, поэтому несущие выделяются за один проход
+    analyzer.feed(noise.samples, carrier.measured);
+    buildCarrier(carrier);
+    return std::move(carrier.sound);
+}
+
+bool Sensor::SoundFormatter::seekCarrier(size_t sample_begin) {
+    while (audio.consumed() < sample_begin) {
+        if (!audio.waitForData(1))
+            return false;
+        audio.consume(std::min(audio.size(), sample_begin - audio.consumed()));
     }
-    std::cout << "Перевод окончен" << std::endl;
+    return true;
+}
+
+bool Sensor::SoundFormatter::splitCarrier(Carrier& carrier) {
+    if (analyzer.feed(audio, carrier.measured))
+        return false;
+    return audio.waitForData(analyzer.pending());
+}
+
+void Sensor::SoundFormatter::buildCarrier(Carrier& carrier) {
+    for (const auto& measured : carrier.measured) {
+        // Ищем еще не уточненный звук, ближайший по частоте к несущей
+        syllable::Sound* nearest = nullptr;
+        for (size_t iter = 0; iter < carrier.sound.size(); iter++) {
+            syllable::Sound& sound = carrier.sound[iter];
+            if (carrier.refined[iter] || std::abs(measured.frequency - sound.frequency) > carrier.tolerance)
+                continue;
+            if (!nearest ||
+                std::abs(measured.frequency - sound.frequency) < std::abs(measured.frequency - nearest->frequency))
+                nearest = &sound;
+        }
+        if (!nearest)
+            continue;
+        // Определяем среднюю частоту, громкость и длительность несущей
+        carrier.refined[nearest - carrier.sound.data()] = true;
+        nearest->frequency = measured.frequency;
+        nearest->volume    = measured.volume;
+        nearest->duration  = measured.duration;
+    }
+    carrier.measured.clear();
+}
+
+std::span<const animal::DecodedAnimalCharacteristic> Translator::translate(animal::PreparedData& prepared_data) {
+    TRACE_SCOPE("Translator::translate");
+    const size_t animal_count = prepared_data.pantomime.size();
+    // Буферы кадра общие с пакетным переводом: оба перевода выполняются только потоком устройства или конвейера
+    auto& decoded = frame_decoded;
+    auto& types   = scratch.types;
+    decoded.resize(animal_count);
+    types.resize(animal_count);
+    if (!quiet_)
+        output::line() << "Начинаем перевод...";
+    // Заново переводятся только новые животные и животные, признаки которых изменились
+    scratch.frame.clear();
+    scratch.index.clear();
+    scratch.slots.clear();
+    scratch.deferred.clear();
+    scratch.pantomime.clear();
+    scratch.sound.clear();
+    collectChanged(prepared_data, 0, decoded);
+    const size_t changed_count = scratch.index.size();
+    scratch.templates.resize(changed_count);
+    // Классифицируем всех животных кадра одним пакетом
+    {
+        latency::Span classify(latency::kClassify);
+        classifyBatch(scratch.pantomime, scratch.sound, std::span(types).first(changed_count));
+    }
+    // Раскладываем виды по номерам животных в кадре. С конца, так как номер животного в кадре не меньше
+    // его номера в пакете и еще не разложенные виды не перезаписываются
+    for (size_t iter = changed_count; iter-- > 0;) types[scratch.index[iter]] = types[iter];
+    // Перевод каждого существа в кадре независим от остальных, результаты складываются по его порядковому номеру
+    auto translateRange = [this, &prepared_data, &types, &decoded](size_t begin, size_t end) {
+        for (size_t changed = begin; changed < end; changed++) {
+            const size_t iter = scratch.index[changed];
+            // Выделяем языковыве сигналы
+            animal::DecodedAnimalCharacteristic animal =
+                predictAnimalCharacteristic(prepared_data.pantomime, prepared_data.sound, types, iter);
+            animal.track = decoded[iter].track;
+            // Пытаемся понять, какое настроение и какие потребности у животного и что оно хочет сказать
+            latency::Span need_span(latency::kNeed);
+            const Prediction prediction = predict(animal);
+            need_span.stop();
+            // Подготовливаем сообщение перевода
+            latency::Span message_span(latency::kMessage);
+            animal.message = translateMessage(prediction.message_template);
+            message_span.stop();
+            scratch.templates[changed] = prediction.message_template;
+            decoded[iter]              = std::move(animal);
+        }
+    };
+    if (changed_count < kParallelThreshold || backends.get(execution::kDecode) != execution::kThreaded)
+        translateRange(0, changed_count);
+    else
+        pool.parallelFor(changed_count, kAnimalsPerTask, translateRange);
+    for (size_t changed = 0; changed < changed_count; changed++)
+        rememberTracked(changed, types[scratch.index[changed]], scratch.templates[changed]);
+    if (!quiet_)
+        output::line() << "Перевод окончен";
     return decoded;
 }
 
+void Translator::translateBatch(std::span<animal::PreparedData> frames,
+                                std::vector<std::vector<animal::DecodedAnimalCharacteristic>>& decoded) {
+    TRACE_SCOPE("Translator::translateBatch");
+    latency::Span span(latency::kTranslateBatch);
+    // Раскладываем признаки животных всех кадров в общие плотные массивы; животные, признаки которых не
+    // изменились с прошлого кадра, получают прежний перевод сразу, сохраняя выделенную ранее память выходных массивов
+    scratch.frame.clear();
+    scratch.index.clear();
+    scratch.slots.clear();
+    scratch.deferred.clear();
+    scratch.pantomime.clear();
+    scratch.sound.clear();
+    decoded.resize(frames.size());
+    for (size_t frame = 0; frame < frames.size(); frame++) {
+        decoded[frame].resize(frames[frame].pantomime.size());
+        collectChanged(frames[frame], frame, decoded[frame]);
+    }
+    const size_t animal_count = scratch.frame.size();
+    if (!quiet_)
+        output::line() << "Начинаем пакетный перевод " << frames.size() << " кадров (" << animal_count
+                       << " животных)...";
+    scratch.animals.resize(animal_count);
+    scratch.moods.resize(animal_count);
+    scratch.needs.resize(animal_count);
+    scratch.templates.resize(animal_count);
+
+    // Классификация животных всего пакета
+    scratch.types.resize(animal_count);
+    latency::Span classify(latency::kClassify);
+    classifyBatch(scratch.pantomime, scratch.sound, scratch.types);
+    classify.stop();
+    // Реализация перевода выбирается один раз на пакет
+    const bool parallel = backends.get(execution::kDecode) == execution::kThreaded;
+    forEachAnimal(animal_count, parallel,
+                  [this](size_t iter) { scratch.animals[iter].animal_type = scratch.types[iter]; });
+    // Пантомимика и звук
+    /// @todo Заглушка, как и predictPantomime/predictSound: признаки берутся из пакета без предсказания
+    forEachAnimal(animal_count, parallel, [this](size_t iter) {
+        animal::DecodedAnimalCharacteristic& animal = scratch.animals[iter];
+        animal.animal.body                          = scratch.pantomime.at(iter);
+        animal.animal.sound                         = scratch.sound.at(iter);
+    });
+    // Прогнозы для повторяющихся признаков берутся из кэша, стадии прогноза выполняются только для остальных
+    const bool memoize = memoize_.load(std::memory_order_relaxed);
+    scratch.keys.resize(animal_count);
+    scratch.misses.clear();
+    for (size_t iter = 0; iter < animal_count; iter++) {
+        Prediction prediction;
+        const animal::DecodedAnimalCharacteristic& animal = scratch.animals[iter];
+        scratch.keys[iter] = featureKey(animal.animal_type, animal.animal.body, animal.animal.sound);
+        if (memoize && predictions.find(scratch.keys[iter], prediction)) {
+            scratch.needs[iter]     = prediction.need;
+            scratch.templates[iter] = prediction.message_template;
+        } else {
+            scratch.misses.push_back(iter);
+        }
+    }
+    const size_t miss_count = scratch.misses.size();
+    // Настроение
+    forEachAnimal(miss_count, parallel, [this](size_t miss) {
+        const size_t iter   = scratch.misses[miss];
+        scratch.moods[iter] = predictMood(scratch.animals[iter]);
+    });
+    // Потребность
+    forEachAnimal(miss_count, parallel, [this](size_t miss) {
+        const size_t iter   = scratch.misses[miss];
+        scratch.needs[iter] = predictNeed(scratch.animals[iter], scratch.moods[iter]);
+    });
+    // Шаблон сообщения
+    forEachAnimal(miss_count, parallel, [this](size_t miss) {
+        const size_t iter       = scratch.misses[miss];
+        scratch.templates[iter] = predictMessageTemplate(scratch.animals[iter], scratch.needs[iter]);
+    });
+    if (memoize) {
+        for (const size_t iter : scratch.misses)
+            predictions.insert(scratch.keys[iter], (Prediction){scratch.needs[iter], scratch.templates[iter]});
+    }
+    // Перевод шаблона на необходимый язык
+    forEachAnimal(animal_count, parallel, [this](size_t iter) {
+        scratch.animals[iter].message = translateMessage(scratch.templates[iter]);
+    });
+
+    // Раскладываем результаты по кадрам
+    for (size_t iter = 0; iter < animal_count; iter++) {
+        animal::DecodedAnimalCharacteristic& animal = decoded[scratch.frame[iter]][scratch.index[iter]];
+        animal.animal_type                          = scratch.animals[iter].animal_type;
+        animal.message                              = scratch.animals[iter].message;
+        rememberTracked(iter, scratch.animals[iter].animal_type, scratch.templates[iter]);
+    }
+    for (const auto [frame, index, iter] : scratch.deferred) {
+        decoded[frame][index].animal_type = scratch.animals[iter].animal_type;
+        decoded[frame][index].message     = scratch.animals[iter].message;
+    }
+    if (!quiet_)
+        output::line() << "Пакетный перевод окончен";
+}
+
+void Translator::classifyBatch(const pantomime::PantomimeBatch& pantomime, const syllable::SoundBatch& sound,
+                               std::span<animal::AnimalType> types) {
+    const size_t count    = pantomime.count();
+    const bool specialize = specialize_.load(std::memory_order_relaxed);
+    switch (backends.get(execution::kClassify)) {
+        case execution::kScalar:
+            classifier.classify(pantomime, sound, types, AnimalClassifier::kScalar, 0, count, specialize);
+            return;
+        case execution::kThreaded:
+            pool.parallelFor(count, kClassifyPerTask,
+                             [this, &pantomime, &sound, types, specialize](size_t begin, size_t end) {
+                                 classifier.classify(pantomime, sound, types, classifier.bestIsa(), begin, end,
+                                                     specialize);
+                             });
+            return;
+        default:
+            classifier.classify(pantomime, sound, types, classifier.bestIsa(), 0, count, specialize);
+            return;
+    }
+}
+
+void Translator::forEachAnimal(size_t count, bool parallel, const std::function<void(size_t)>& body) {
+    if (!parallel || count < kParallelThreshold) {
+        for (size_t iter = 0; iter < count; iter++) body(iter);
+        return;
+    }
+    pool.parallelFor(count, kAnimalsPerTask, [&body](size_t begin, size_t end) {
+        for (size_t iter = begin; iter < end; iter++) body(iter);
+    });
+}
+
 animal::DecodedAnimalCharacteristic Translator::predictAnimalCharacteristic(std::vector<pantomime::Pantomime>& video,
                                                                             std::vector<syllable::Sound>& sound,
                                                                             std::vector<animal::AnimalType>& types,
@@ -118,7 +435,6 @@ syllable::Sound Translator::predictSound(std::vector<syllable::Sound>& sound, an
 
 animal::AnimalType Translator::predictAnimal(pantomime::Pantomime& pantomime, syllable::Sound& sound,
                                              std::vector<animal::AnimalType>& types, size_t iter) {
-    /// @todo Заглушка. Вместо реальной классификации, просто забираем данные с потока
     return types[iter];
 }
 
@@ -139,117 +455,443 @@ Translator::Need Translator::predictNeed(animal::DecodedAnimalCharacteristic& an
 
 Translator::MessageTemplate Translator::predictMessageTemplate(animal::DecodedAnimalCharacteristic& animal,
                                                                Translator::Need& need) {
-    /// @todo Заглушка. Здесь шаблон должен выбираться на основании входных признаков, а не рандомно
-    return (MessageTemplate)(std::rand() % kMaxMessageTemplate);
+    /// @todo Заглушка. Шаблон выбирается по простым правилам; как и настоящая модель, он должен зависеть только
+    /// от признаков, входящих в ключ кэша прогнозов (см. featureKey)
+    const pantomime::Pantomime& body = animal.animal.body;
+    const syllable::Sound& sound     = animal.animal.sound;
+    if (body.body == pantomime::Threat || body.facial == pantomime::Anger || sound.larinx == syllable::Hiss ||
+        sound.larinx == syllable::Growl)
+        return messages::kAfraid;
+    if (body.gestures == pantomime::Playful || body.facial == pantomime::Happiness)
+        return messages::kPlay;
+    if (sound.throat == syllable::None)
+        return messages::kLorem;
+    return messages::kGoulash;
+}
+
+std::string_view Translator::translateMessage(Translator::MessageTemplate message_template) {
+    // Язык выбирается на каждом устройстве отдельно, каталог сообщений общий для всех устройств
+    const messages::Catalog& catalog = messages::current();
+    return catalog.message(resolveLocale(catalog), message_template);
 }
 
-std::string Translator::translateMessage(Translator::MessageTemplate message_template) {
-    // Выбор необходимой локали. Здесь подумать на кнопкой изменения языка.
-    // Стоит ли делать для разных стран разные устройства или добавить кнопку замены языка?
-    // В требованиях закрепленного решения нет и оно не срочное, откладываем на попозже.
-    return message_locale[RU][message_template];
+bool Translator::setLocale(std::string_view name) {
+    const messages::Catalog& catalog = messages::current();
+    const messages::Locale locale    = catalog.findLocale(name);
+    if (locale == messages::kNoLocale)
+        return false;
+    std::lock_guard lock(locale_mu_);
+    locale_name_ = name;
+    resolved_locale_.store({.generation = catalog.generation(), .locale = locale}, std::memory_order_release);
+    return true;
 }
 
-std::string Translator::predictMessage(animal::DecodedAnimalCharacteristic& animal, Need& need) {
-    // Подготавливаем шаблон сообщения
-    Translator::MessageTemplate message_template = predictMessageTemplate(animal, need);
-    // Переводим шаблон на необходимый язык
-    return translateMessage(message_template);
+std::string_view Translator::localeName() const {
+    const messages::Catalog& catalog = messages::current();
+    return catalog.localeName(resolveLocale(catalog));
 }
 
-Monitor::Monitor() {
-    animal_names[animal::Cat]    = "котика";
-    animal_names[animal::Dog]    = "собачку";
-    animal_names[animal::Parrot] = "попугайчика";
-    animal_names[animal::Sheep]  = "овечку";
-    animal_names[animal::Cow]    = "корову";
+messages::Locale Translator::resolveLocale(const messages::Catalog& catalog) const {
+    const ResolvedLocale resolved = resolved_locale_.load(std::memory_order_acquire);
+    if (resolved.generation == catalog.generation())
+        return resolved.locale;
+    // Каталог заменен после прошлого поиска: номер языка в прежнем каталоге к новому каталогу не относится
+    std::lock_guard lock(locale_mu_);
+    const messages::Locale found  = catalog.findLocale(locale_name_);
+    const messages::Locale locale = found == messages::kNoLocale ? 0 : found;
+    resolved_locale_.store({.generation = catalog.generation(), .locale = locale}, std::memory_order_release);
+    return locale;
 }
 
-void Monitor::display(std::vector<animal::DecodedAnimalCharacteristic> animals) {
-    std::cout << "Происходит вывод на экран:" << std::endl;
-    std::cout << "------------------------------" << std::endl;
-    std::cout << "На изображении найдено " << animals.size() << " животных" << std::endl << std::endl;
-    for (auto& animal : animals) {
-        std::cout << "Информация о животном:" << std::endl;
-        std::cout << "Мы видим здесь " << animal_names[animal.animal_type] << std::endl;
-        std::cout << "Кажется, животное вам хочет сказать следующее:" << std::endl;
-        std::cout << animal.message << std::endl << std::endl;
+Translator::Prediction Translator::predict(animal::DecodedAnimalCharacteristic& animal) {
+    auto compute = [this, &animal] {
+        Need need = translateNeed(animal);
+        return (Prediction){need, predictMessageTemplate(animal, need)};
+    };
+    if (!memoize_.load(std::memory_order_relaxed))
+        return compute();
+    return predictions.getOrCompute(featureKey(animal.animal_type, animal.animal.body, animal.animal.sound), compute);
+}
+
+void Translator::runSpeciesBenchmark(size_t animal_count) {
+    static constexpr size_t kRepeats = 20;
+    using Clock                      = std::chrono::steady_clock;
+    // Случайные животные всех видов вперемешку, как в кадрах
+    pantomime::PantomimeBatch pantomime;
+    syllable::SoundBatch sound;
+    for (size_t iter = 0; iter < animal_count; iter++) {
+        const animal::DecodedAnimalCharacteristic animal = animal::random::generateAnimal();
+        pantomime.push_back(animal.animal.body);
+        sound.push_back(animal.animal.sound);
+    }
+    // Замер одного способа: время kRepeats повторов, с
+    auto measure = [](auto&& run) {
+        const auto start = Clock::now();
+        for (size_t repeat = 0; repeat < kRepeats; repeat++) run();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+    // Скалярная классификация: признаки видов из таблиц или константы, развернутые по видам
+    std::vector<animal::AnimalType> generic_types(animal_count), types(animal_count);
+    auto classify = [&](std::vector<animal::AnimalType>& result, bool specialized) {
+        return measure([&] {
+            classifier.classify(pantomime, sound, result, AnimalClassifier::kScalar, 0, animal_count, specialized);
+        });
+    };
+    const double generic = classify(generic_types, false);
+    const double species = classify(types, true);
+    const double count   = (double)animal_count * kRepeats;
+    output::line() << "Замер классификации, специализированной по видам: животных " << animal_count;
+    output::line() << "\tпо таблицам " << count / generic << " животных/с, по видам " << count / species
+                   << " животных/с, ускорение " << generic / species
+                   << (generic_types == types ? "" : ", результаты различаются");
+}
+
+void Translator::collectChanged(const animal::PreparedData& data, size_t frame,
+                                std::span<animal::DecodedAnimalCharacteristic> decoded) {
+    const bool incremental = incremental_.load(std::memory_order_relaxed);
+    if (incremental) {
+        tracker.update(data.pantomime, data.sound, track_slots);
+        tracked.resize(tracker.capacity());
+    }
+    for (size_t iter = 0; iter < data.pantomime.size(); iter++) {
+        animal::DecodedAnimalCharacteristic& animal = decoded[iter];
+        animal.animal                               = {.body = data.pantomime[iter], .sound = data.sound[iter]};
+        animal.track                                = 0;
+        size_t slot                                 = kNoTrack;
+        if (incremental) {
+            slot                     = track_slots[iter];
+            animal.track             = tracker.track(slot).id;
+            TrackedTranslation& last = tracked[slot];
+            const uint64_t key       = featureKey(animal::MaxAnimalType, animal.animal.body, animal.animal.sound);
+            const pantomime::Pantomime& body = animal.animal.body;
+            const syllable::Sound& sound     = animal.animal.sound;
+            if (last.id == animal.track && last.key == key && last.size == body.size &&
+                last.volume == sound.volume && last.frequency == sound.frequency) {
+                reused_.fetch_add(1, std::memory_order_relaxed);
+                if (last.pending != kNoTrack) {
+                    scratch.deferred.push_back({frame, iter, last.pending});
+                    continue;
+                }
+                // Сообщение берется из каталога заново, так как язык мог смениться
+                animal.animal_type = last.type;
+                animal.message     = translateMessage(last.message_template);
+                continue;
+            }
+            last = (TrackedTranslation){.id        = animal.track,
+                                        .key       = key,
+                                        .size      = body.size,
+                                        .volume    = sound.volume,
+                                        .frequency = sound.frequency,
+                                        .pending   = scratch.frame.size()};
+        }
+        scratch.frame.push_back(frame);
+        scratch.index.push_back(iter);
+        scratch.slots.push_back(slot);
+        scratch.pantomime.push_back(data.pantomime[iter]);
+        scratch.sound.push_back(data.sound[iter]);
     }
-    std::cout << "------------------------------" << std::endl;
+}
+
+void Translator::rememberTracked(size_t iter, animal::AnimalType type, MessageTemplate message_template) {
+    // Ячейка могла перейти другому животному, а трек - получить более новый перевод в этом же пакете
+    const size_t slot = scratch.slots[iter];
+    if (slot == kNoTrack || tracked[slot].pending != iter)
+        return;
+    tracked[slot].type             = type;
+    tracked[slot].message_template = message_template;
+    tracked[slot].pending          = kNoTrack;
+}
+
+uint64_t Translator::featureKey(animal::AnimalType type, const pantomime::Pantomime& body,
+                                const syllable::Sound& sound) {
+    // Частота в полутонах от 1 Гц: 8 бит покрывают весь слышимый животными диапазон
+    const uint64_t frequency = std::clamp(std::lround(12 * std::log2(std::max(sound.frequency, 1.0))), 0l, 255l);
+    const uint64_t volume    = std::clamp(sound.volume / kVolumeStep, 0, 255);
+    uint64_t key             = type;
+    key                      = key << 3 | body.facial;
+    key                      = key << 3 | body.body;
+    key                      = key << 3 | body.gestures;
+    key                      = key << 3 | sound.larinx;
+    key                      = key << 3 | sound.throat;
+    key                      = key << 8 | frequency;
+    return key << 8 | volume;
+}
+
+void Monitor::display(std::span<const animal::DecodedAnimalCharacteristic> animals) {
+    TRACE_SCOPE("Monitor::display");
+    latency::Span span(latency::kDisplay);
+    // Монитор передает выводу типизированные записи, а текст экрана собирает поток вывода
+    output::Sink& sink = output::sink();
+    if (sink.quiet())
+        return;
+    sink.submit(output::makeRecord(output::RecordType::kDisplayBegin, {}, animals.size()));
+    for (const auto& animal : animals)
+        sink.submit(output::makeRecord(output::RecordType::kAnimal, animal.message, (uint32_t)animal.track,
+                                       animal.animal_type));
+    sink.submit(output::makeRecord(output::RecordType::kDisplayEnd));
 }
 
 void AnimalTranslatinator::turnOn() {
-    std::cout << "На устройстве нажата кнопка включения" << std::endl;
+    output::line() << "На устройстве нажата кнопка включения";
     power_ = true;
 }
 
 void AnimalTranslatinator::turnOff() {
-    std::cout << "На устройстве нажата кнопка выключения" << std::endl;
+    output::line() << "На устройстве нажата кнопка выключения";
+    pipeline.stop();
     power_ = false;
 }
 
+void AnimalTranslatinator::startStreaming() {
+    if (!power_) {
+        output::line() << "Кажется, устройство выключено";
+        return;
+    }
+    output::line() << "Устройство переходит в потоковый режим";
+    pipeline.start();
+}
+
+void AnimalTranslatinator::stopStreaming() {
+    output::line() << "Устройство выходит из потокового режима";
+    pipeline.stop();
+    printStreamingStats();
+}
+
+void AnimalTranslatinator::replay(const std::string& path) {
+    if (!power_) {
+        output::line() << "Кажется, устройство выключено";
+        return;
+    }
+    if (pipeline.running()) {
+        output::line() << "Устройство работает в потоковом режиме, воспроизведение недоступно";
+        return;
+    }
+    session::SessionReader reader;
+    if (!reader.open(path)) {
+        output::line() << "Не удалось открыть запись " << path;
+        return;
+    }
+    output::line() << "Воспроизводим запись " << path << ": бесед " << reader.size();
+    const auto start = std::chrono::steady_clock::now();
+    size_t animal_count = 0, recognized = 0;
+    replayFrames(reader, [&](size_t frame, std::span<const animal::DecodedAnimalCharacteristic> decoded) {
+        // Сверяем определенные виды животных с записанными
+        const auto& types = reader.frame(frame).types;
+        for (size_t animal = 0; animal < decoded.size() && animal < types.size(); animal++)
+            recognized += decoded[animal].animal_type == types[animal];
+        animal_count += types.size();
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    output::line() << "Воспроизведение окончено: бесед " << reader.size() << ", животных " << animal_count
+                   << ", узнано " << recognized << ", за " << elapsed.count() << " с ("
+                   << reader.size() / elapsed.count() << " бесед/с, " << reader.bytes() / elapsed.count() / (1 << 20)
+                   << " МБ/с)";
+}
+
+void AnimalTranslatinator::checkTracking(const std::string& path) {
+    if (!power_) {
+        output::line() << "Кажется, устройство выключено";
+        return;
+    }
+    if (pipeline.running()) {
+        output::line() << "Устройство работает в потоковом режиме, проверка недоступна";
+        return;
+    }
+    session::SessionReader reader;
+    if (!reader.open(path)) {
+        output::line() << "Не удалось открыть запись " << path;
+        return;
+    }
+    const bool incremental = translator.incremental();
+    // Сначала все животные переводятся заново, затем переводы сравниваются с инкрементальными
+    std::vector<std::pair<animal::AnimalType, std::string_view>> expected;
+    translator.setIncremental(false);
+    replayFrames(reader, [&expected](size_t, std::span<const animal::DecodedAnimalCharacteristic> decoded) {
+        for (const auto& animal : decoded) expected.emplace_back(animal.animal_type, animal.message);
+    });
+    size_t position = 0, mismatched = 0;
+    translator.setIncremental(true);
+    replayFrames(reader, [&](size_t, std::span<const animal::DecodedAnimalCharacteristic> decoded) {
+        for (const auto& animal : decoded) {
+            mismatched += position >= expected.size() || expected[position].first != animal.animal_type ||
+                          expected[position].second != animal.message;
+            position++;
+        }
+    });
+    translator.setIncremental(incremental);
+    mismatched += expected.size() - std::min(position, expected.size());
+    output::line() << "Проверка сопровождения на записи " << path << ": бесед " << reader.size() << ", животных "
+                   << expected.size() << ", расхождений " << mismatched;
+    if (mismatched)
+        output::line() << "ОШИБКА: инкрементальный перевод отличается от полного";
+    else
+        output::line() << "Проверка пройдена: инкрементальный перевод совпадает с полным";
+}
+
+void AnimalTranslatinator::replayFrames(
+    const session::SessionReader& reader,
+    const std::function<void(size_t, std::span<const animal::DecodedAnimalCharacteristic>)>& visit) {
+    // Подготовленные данные пакета переиспользуются от пакета к пакету, кадры записи в них не копируются заново
+    std::vector<animal::PreparedData> batch(std::min(reader.size(), kReplayBatch));
+    std::vector<std::vector<animal::DecodedAnimalCharacteristic>> decoded;
+    for (size_t first = 0; first < reader.size(); first += kReplayBatch) {
+        const size_t last = std::min(reader.size(), first + kReplayBatch);
+        for (size_t iter = first; iter < last; iter++) sensor.prepareData(reader.frame(iter), batch[iter - first]);
+        translator.translateBatch(std::span(batch).first(last - first), decoded);
+        for (size_t iter = first; iter < last; iter++) visit(iter, decoded[iter - first]);
+    }
+}
+
+size_t AnimalTranslatinator::serve(size_t budget, size_t& animals) {
+    TRACE_SCOPE("AnimalTranslatinator::serve");
+    animals = 0;
+    if (!power_ || pipeline.running())
+        return 0;
+    serve_batch.clear();
+    while (serve_batch.size() < budget) {
+        animal::PackedData packed_data = sensor.tryCollectData();
+        if (!packed_data.ready)
+            break;
+        serve_batch.push_back(sensor.prepareData(packed_data));
+    }
+    if (serve_batch.empty())
+        return 0;
+    translator.translateBatch(serve_batch, serve_decoded);
+    for (const auto& frame : serve_batch) animals += frame.pantomime.size();
+    return serve_batch.size();
+}
+
+void AnimalTranslatinator::printStreamingStats() {
+    output::line() << "Состояние потокового режима:";
+    const auto stats = pipeline.stats();
+    for (size_t stage = 0; stage < StreamingPipeline::kMaxStage; stage++) {
+        const auto& stage_stats = stats[stage];
+        output::line() << "\t" << StreamingPipeline::kStageNames[stage] << ": обработано " << stage_stats.processed
+                       << ", очередь " << stage_stats.queue_depth << " (максимум " << stage_stats.max_queue_depth
+                       << "), работа " << stage_stats.busy_seconds << " с, простой на входе "
+                       << stage_stats.input_stall << " с, простой на выходе " << stage_stats.output_stall << " с";
+    }
+}
+
+bool AnimalTranslatinator::setLocale(std::string_view name) {
+    if (!translator.setLocale(name))
+        return false;
+    if (!quiet_)
+        output::line() << "Язык сообщений: " << name;
+    return true;
+}
+
+void AnimalTranslatinator::printPredictionStats(bool reset) {
+    const auto stats     = translator.predictionStats();
+    const uint64_t total = stats.hits + stats.misses;
+    output::line() << "Кэш прогнозов" << (translator.memoization() ? "" : " (выключен)") << ": попаданий "
+                   << stats.hits << ", промахов " << stats.misses << " ("
+                   << (total ? 100.0 * stats.hits / total : 0) << "% попаданий), вытеснений " << stats.evictions
+                   << ", занято " << stats.size << " из " << stats.capacity << " записей";
+    if (reset)
+        translator.resetPredictions();
+}
+
+void AnimalTranslatinator::printTrackingStats() {
+    const auto stats = translator.trackingStats();
+    output::line() << "Сопровождение животных" << (translator.incremental() ? "" : " (выключено)") << ": кадров "
+                   << stats.frames << ", найдено в прошлых кадрах " << stats.matched << ", новых животных "
+                   << stats.created << ", потеряно " << stats.lost << ", переводов без пересчета "
+                   << translator.reusedTranslations();
+}
+
+std::string_view AnimalTranslatinator::localeName() const { return translator.localeName(); }
+
 static double signedCorrection(double value) {
-    return (std::rand() % 2) ? value : -value;
+    return prng::local().below(2) ? value : -value;
 }
 
 static double correction() {
-    return 1 + signedCorrection((double)std::rand() / RAND_MAX / 10);
+    return 1 + signedCorrection(prng::local().real() / 10);
 }
 
-double AnimalTranslatinator::startListening(std::deque<animal::AnimalDecodingStub>& types) {
+ListenTiming AnimalTranslatinator::startListening() {
+    ListenTiming timing = {};
+    if (!power_) {
+        output::line() << "Кажется, устройство выключено";
+        return timing;
+    }
+    output::line() << "На устройстве нажата кнопка прослушивания";
+    if (pipeline.running()) {
+        output::line() << "Устройство работает в потоковом режиме, прослушивание недоступно";
+        return timing;
+    }
+    output::line() << "Устройство ждет окончания беседы";
+    animal::PackedData packed_data;
+    {
+        TRACE_SCOPE("Sensor::collectData");
+        latency::Span collect(latency::kCollect);
+        packed_data = sensor.collectData();
+    }
+    if (!packed_data.ready) {
+        output::line() << "Беседа так и не состоялась";
+        return timing;
+    }
+    // Ожидание беседы не входит в длительность обработки
+    latency::Span listen(latency::kListen);
+    TRACE_SCOPE("AnimalTranslatinator::startListening");
+    const size_t allocations = memory::allocations();
+    // Подготовка первичных данных
+    animal::PreparedData prepared_data = sensor.prepareData(packed_data);
+    // Перевод сообщения
+    auto messages = translator.translate(prepared_data);
+    // Вывод пеервода на экран
+    monitor.display(messages);
+    timing.measured    = listen.stop();
+    timing.allocations = memory::allocations() - allocations;
+    if (projection_)
+        timing.projected = project();
+    return timing;
+}
+
+double AnimalTranslatinator::project() {
     double time_counter = 0;
-    if (power_) {
-        std::cout << "На устройстве нажата кнопка прослушивания" << std::endl;
-        // Подготовка первичных данных
-        animal::PreparedData prepared_data = sensor.prepareBatchOfData();
-
-        double video_time_;
-        if (hardware_video_) {
-            video_time_ = (double)kHardwareVideoStep.second / kHardFreq / 1000000000;
-        } else {
-            video_time_ = (double)kHardwareVideoStep.first / kSoftFreq / 1000000000;
-        }
-        video_time_ *= correction();
-        std::cout << "Обработка видео заняла " << video_time_ << " секунд" << std::endl;
-        time_counter += video_time_;
+    output::line() << "Проекция на аппаратуру устройства:";
+    // Векторная и многопоточная реализации проецируются на аппаратное исполнение стадии
+    double video_time_;
+    if (backends_.get(execution::kVideo) != execution::kScalar) {
+        video_time_ = (double)kHardwareVideoStep.second / kHardFreq / 1000000000;
+    } else {
+        video_time_ = (double)kHardwareVideoStep.first / kSoftFreq / 1000000000;
+    }
+    video_time_ *= correction();
+    output::line() << "\tОбработка видео заняла бы " << video_time_ << " секунд";
 
-        double audio_time_;
-        if (hardware_audio_) {
-            audio_time_ = (double)kHardwareAudioStep.second / kHardFreq / 1000000000;
-        } else {
-            audio_time_ = (double)kHardwareAudioStep.first / kSoftFreq / 1000000000;
-        }
-        audio_time_ *= correction();
-        std::cout << "Обработка аудио заняла " << audio_time_ << " секунд" << std::endl;
-        time_counter += audio_time_;
-
-        if (!prepared_data.ready)
-            return 0;
-        // Перевод сообщения
-        auto messages = translator.translate(prepared_data, types.front().types);
-
-        double classify_time_ =
-            kHardwareClassifyStep[hardware_classify] / kHardwareClassifyFreq[hardware_classify] / 1000000000;
-        classify_time_ *= correction();
-        std::cout << "Классификация животного заняла " << classify_time_ << " секунд" << std::endl;
-        time_counter += classify_time_;
-
-        double decoding_time_;
-        if (hardware_decoding_) {
-            decoding_time_ = (double)kHardwareDecodingStep.second / kHardFreq / 1000000000;
-        } else {
-            decoding_time_ = (double)kHardwareDecodingStep.first / kSoftFreq / 1000000000;
-        }
-        decoding_time_ *= correction();
-        std::cout << "Определение настроения животного заняло " << decoding_time_ << " секунд" << std::endl;
-        time_counter += decoding_time_;
+    double audio_time_;
+    if (backends_.get(execution::kAudio) != execution::kScalar) {
+        audio_time_ = (double)kHardwareAudioStep.second / kHardFreq / 1000000000;
+    } else {
+        audio_time_ = (double)kHardwareAudioStep.first / kSoftFreq / 1000000000;
+    }
+    audio_time_ *= correction();
+    output::line() << "\tОбработка аудио заняла бы " << audio_time_ << " секунд";
+    if (sensor.parallelFormatting()) {
+        // Видео и звук обрабатываются одновременно, поэтому длительность определяется критическим путем
+        time_counter += std::max(video_time_, audio_time_);
+    } else {
+        time_counter += video_time_ + audio_time_;
+    }
+
+    const execution::Backend classify = backends_.get(execution::kClassify);
+    double classify_time_             = kClassifyStep[classify] / kClassifyFreq[classify] / 1000000000;
+    classify_time_ *= correction();
+    output::line() << "\tКлассификация животного заняла бы " << classify_time_ << " секунд";
+    time_counter += classify_time_;
 
-        types.pop_front();
-        // Вывод пеервода на экран
-        monitor.display(messages);
+    double decoding_time_;
+    if (backends_.get(execution::kDecode) != execution::kScalar) {
+        decoding_time_ = (double)kHardwareDecodingStep.second / kHardFreq / 1000000000;
     } else {
-        std::cout << "Кажется, устройство выключено" << std::endl;
+        decoding_time_ = (double)kHardwareDecodingStep.first / kSoftFreq / 1000000000;
     }
+    decoding_time_ *= correction();
+    output::line() << "\tОпределение настроения животного заняло бы " << decoding_time_ << " секунд";
+    time_counter += decoding_time_;
     return time_counter;
 }
 
@@ -4,12 +4,23 @@
  * @version 1.0
  */
 
+#include "benchmark.h"
+#include "blocking_queue.h"
+#include "device_host.h"
+#include "frame_bus.h"
+#include "load_generator.h"
+#include "message_catalog.h"
+#include "output.h"
 #include "reactor.h"
+#include "task_pool.h"
+#include "trace.h"
 #include "translator.h"
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <thread>
 
-enum Command {
+enum CommandType {
     kTalk,
     kListen,
     kOn,
@@ -23,75 +34,448 @@ enum Command {
     kCpuClassify,
     kHardDecoding,
     kSoftDecoding,
+    kBackend,
+    kParallelFormatting,
+    kSerialFormatting,
+    kStreamStart,
+    kStreamStop,
+    kStreamStats,
+    kRecord,
+    kReplay,
+    kLoad,
+    kHost,
+    kOutput,
+    kLatency,
+    kProjection,
+    kTrace,
+    kLocale,
+    kCatalog,
+    kPredictionCache,
+    kTracking,
+    kSpecies,
+    kBenchmark,
     kExit
 };
 
-std::deque<Command> commandQueue;
+/// @brief Команда с необязательным аргументом (например, путем к файлу)
+struct Command {
+    CommandType type;
+    std::string argument;
+};
+
+/// @brief Команды устройства-переводчика
+concurrency::BlockingQueue<Command> commandQueue;
+/// @brief Команды окружения. Обрабатываются отдельно, чтобы не стоять в очереди за долгим прослушиванием
+concurrency::BlockingQueue<Command> reactorQueue;
+
+/// @brief Количество кадров, которые окружение может накопить до начала прослушивания
+static constexpr size_t kFrameRingCapacity = 64;
+
+/// @brief Максимальное количество источников генератора нагрузки
+static constexpr size_t kMaxLoadProducers = 8;
+
+/// @brief Количество кадров, которое может накопить каждый источник генератора нагрузки
+static constexpr size_t kLoadLaneCapacity = 16;
+
+/// @brief Максимальное количество устройств при замере узла
+static constexpr size_t kMaxHostedDevices = 256;
+
+/// @brief Длительность замера узла для одного количества устройств, с
+static constexpr double kHostBenchmarkSeconds = 2;
+
+/// @brief Количество строк замера вывода по умолчанию
+static constexpr size_t kOutputBenchmarkRecords = 1000000;
+
+/// @brief Количество животных замера классификации по видам по умолчанию
+static constexpr size_t kSpeciesBenchmarkAnimals = 100000;
+
+/// @brief Количество команд замера очереди команд по умолчанию
+static constexpr size_t kQueueBenchmarkCommands = 10000;
+
+/// @brief Количество кадров замера передачи кадров по умолчанию
+static constexpr size_t kRingBenchmarkFrames = 1000000;
+
+/// @brief Количество кадров замера пула потоков для каждого сочетания потоков и животных по умолчанию
+static constexpr size_t kPoolBenchmarkFrames = 1000;
+
+/// @brief Количество животных замера классификатора по умолчанию
+static constexpr size_t kClassifierBenchmarkAnimals = 100000;
+
+/// @brief Количество животных замера таблиц признаков по умолчанию
+static constexpr size_t kTablesBenchmarkAnimals = 1000000;
+
+/// @brief Длительность записи замера анализа звука по умолчанию, с
+static constexpr size_t kSpectrumBenchmarkSeconds = 10;
+
+/// @brief Количество кадров замера карты глубины по умолчанию
+static constexpr size_t kDepthBenchmarkFrames = 200;
+
+/// @brief Количество кадров проверки выделений памяти в каждом режиме по умолчанию
+static constexpr size_t kAllocationCheckFrames = 20;
+
+/// @brief Емкость потока микрофона в отсчетах (около 0.7 с звука), не зависит от длины бесед
+static constexpr size_t kAudioRingCapacity = 1 << 16;
 
 bool console    = true;
 bool is_working = true;
 
 void listenConsole() {
     while (console) {
-        std::string command;
-        std::cin >> command;
+        std::string line;
+        if (!std::getline(std::cin, line)) {
+            // Поток ввода закрыт, дальнейших команд не будет
+            commandQueue.push({kExit});
+            console = false;
+            continue;
+        }
+        // Команда может состоять из нескольких слов, аргумент отделяется от команды пробелом
+        const size_t begin        = line.find_first_not_of(" \t");
+        const size_t end          = line.find_last_not_of(" \t\r");
+        const std::string command = begin == std::string::npos ? "" : line.substr(begin, end - begin + 1);
+        const size_t space        = command.find(' ');
+        const std::string name    = command.substr(0, space);
+        const std::string argument =
+            space == std::string::npos ? "" : command.substr(command.find_first_not_of(' ', space));
         if (command == "talk")
-            commandQueue.push_back(kTalk);
+            reactorQueue.push({kTalk});
         else if (command == "listen")
-            commandQueue.push_back(kListen);
+            commandQueue.push({kListen});
         else if (command == "on")
-            commandQueue.push_back(kOn);
+            commandQueue.push({kOn});
         else if (command == "off")
-            commandQueue.push_back(kOff);
+            commandQueue.push({kOff});
         else if (command == "hard video")
-            commandQueue.push_back(kHardVideo);
+            commandQueue.push({kHardVideo});
         else if (command == "soft video")
-            commandQueue.push_back(kSoftVideo);
+            commandQueue.push({kSoftVideo});
         else if (command == "hard audio")
-            commandQueue.push_back(kHardAudio);
+            commandQueue.push({kHardAudio});
         else if (command == "soft audio")
-            commandQueue.push_back(kSoftAudio);
+            commandQueue.push({kSoftAudio});
         else if (command == "gpu")
-            commandQueue.push_back(kGpuClassify);
+            commandQueue.push({kGpuClassify});
         else if (command == "npu")
-            commandQueue.push_back(kNpuClassify);
+            commandQueue.push({kNpuClassify});
         else if (command == "cpu")
-            commandQueue.push_back(kCpuClassify);
+            commandQueue.push({kCpuClassify});
         else if (command == "hard decoding")
-            commandQueue.push_back(kHardDecoding);
+            commandQueue.push({kHardDecoding});
         else if (command == "soft decoding")
-            commandQueue.push_back(kSoftDecoding);
+            commandQueue.push({kSoftDecoding});
+        else if (name == "backend")
+            // "backend <стадия> <реализация>" - замена реализации стадии, "backend" - вывод выбранных реализаций
+            commandQueue.push({kBackend, argument});
+        else if (command == "parallel")
+            commandQueue.push({kParallelFormatting});
+        else if (command == "serial")
+            commandQueue.push({kSerialFormatting});
+        else if (command == "stream")
+            commandQueue.push({kStreamStart});
+        else if (command == "stop")
+            commandQueue.push({kStreamStop});
+        else if (command == "stats")
+            commandQueue.push({kStreamStats});
+        else if (name == "record")
+            // Запись ведет окружение: "record <путь>" начинает запись, "record" без пути - заканчивает
+            reactorQueue.push({kRecord, argument});
+        else if (name == "replay" && !argument.empty())
+            commandQueue.push({kReplay, argument});
+        else if (name == "load")
+            // "load <источники> <кадров/с> <секунды> [<мин. животных> <макс. животных>] [<зерно>] [<неподвижных>]",
+            // "load" - остановка; <неподвижных> - доля животных, переходящих в следующий кадр без изменений
+            commandQueue.push({kLoad, argument});
+        else if (name == "host")
+            // "host <устройств>" - замер узла с заданным количеством устройств, "host" - от 1 до 256 устройств
+            commandQueue.push({kHost, argument});
+        else if (name == "latency")
+            // "latency" - вывод задержек стадий, "latency reset" - сброс, "latency <путь>" - выгрузка в CSV
+            commandQueue.push({kLatency, argument});
+        else if (name == "projection")
+            // "projection on|off" - вывод смоделированной длительности обработки рядом с измеренной
+            commandQueue.push({kProjection, argument});
+        else if (name == "trace")
+            // "trace on [<путь>]" - запись трассы (с выгрузкой при выходе), "trace off", "trace <путь>" - выгрузка
+            commandQueue.push({kTrace, argument});
+        else if (name == "lang")
+            // "lang <язык>" - выбор языка сообщений, "lang" - вывод языков каталога
+            commandQueue.push({kLocale, argument});
+        else if (name == "catalog" && !argument.empty())
+            // "catalog <путь>" - загрузка каталога сообщений из текстового файла
+            commandQueue.push({kCatalog, argument});
+        else if (name == "cache")
+            // "cache" - счетчики кэша прогнозов, "cache reset" - вывод и очистка, "cache on|off" - включение кэша
+            commandQueue.push({kPredictionCache, argument});
+        else if (name == "track")
+            // "track" - счетчики сопровождения, "track on|off" - инкрементальный перевод, "track check <путь>" - сверка
+            // инкрементального перевода с полным на записанном сеансе
+            commandQueue.push({kTracking, argument});
+        else if (name == "species")
+            // "species on|off" - классификация, специализированная по видам, "species bench [<животных>]" - замер
+            commandQueue.push({kSpecies, argument});
+        else if (name == "bench")
+            // "bench <замер> [<количество>]" - замер примитива или стадии, "bench" - список замеров
+            commandQueue.push({kBenchmark, argument});
+        else if (name == "output")
+            // "output terminal", "output file <путь>", "output binary <путь>", "output quiet", "output bench [<строк>]"
+            commandQueue.push({kOutput, argument});
         else if (command == "exit") {
-            commandQueue.push_back(kExit);
+            commandQueue.push({kExit});
             console = false;
         }
     }
 }
 
-int main() {
-    std::deque<pantomime::Video> pantomime;
-    std::deque<syllable::Noise> sound;
-    std::deque<animal::AnimalDecodingStub> types;
-    bool reactive_cv_ = false;
+/*!
+ * @brief Разбор параметров нагрузки
+ * @param[in] argument Аргумент команды load
+ * @param[out] profile Параметры нагрузки
+ * @return false, если параметры не удалось разобрать
+ */
+bool parseLoadProfile(const std::string& argument, reactor::LoadProfile& profile) {
+    std::istringstream stream(argument);
+    if (!(stream >> profile.producers >> profile.frames_per_second >> profile.duration))
+        return false;
+    size_t min_animals = 0, max_animals = 0;
+    if (stream >> min_animals >> max_animals) {
+        profile.min_animals = min_animals;
+        profile.max_animals = max_animals;
+        if (stream >> profile.seed)
+            stream >> profile.persistence;
+    }
+    return true;
+}
+
+/*!
+ * @brief Настройка вывода устройства
+ * @param[in] argument Аргумент команды output
+ */
+void configureOutput(const std::string& argument) {
+    std::istringstream stream(argument);
+    std::string mode, path;
+    stream >> mode >> path;
+    output::Sink& sink = output::sink();
+    if (mode == "quiet") {
+        sink.setQuiet(true);
+        return;
+    }
+    if (mode == "bench") {
+        size_t records = kOutputBenchmarkRecords;
+        std::istringstream(path) >> records;
+        output::runBenchmark(records);
+        return;
+    }
+    std::unique_ptr<output::Backend> backend;
+    if (mode == "terminal")
+        backend = output::terminal();
+    else if (mode == "file" && !path.empty())
+        backend = output::textFile(path);
+    else if (mode == "binary" && !path.empty())
+        backend = output::binaryFile(path);
+    else {
+        output::line() << "Формат: output terminal | file <путь> | binary <путь> | quiet | bench [<строк>]";
+        return;
+    }
+    if (!backend) {
+        output::line() << "Не удалось создать файл вывода " << path;
+        return;
+    }
+    sink.setQuiet(false);
+    sink.setBackend(std::move(backend));
+    output::line() << "Вывод переключен: " << mode << (path.empty() ? "" : " ") << path;
+}
+
+/*!
+ * @brief Замена реализации стадии обработки
+ * @param[in,out] translator Устройство
+ * @param[in] argument Аргумент команды backend
+ */
+void configureBackend(translator::AnimalTranslatinator& translator, const std::string& argument) {
+    std::istringstream stream(argument);
+    std::string stage_name, backend_name;
+    stream >> stage_name >> backend_name;
+    if (stage_name.empty()) {
+        for (size_t stage = 0; stage < execution::kMaxStage; stage++) {
+            const auto backend = translator.backends().get(static_cast<execution::Stage>(stage));
+            output::line() << "\t" << execution::kStageNames[stage] << ": " << execution::kBackendNames[backend];
+        }
+        return;
+    }
+    const execution::Stage stage     = execution::parseStage(stage_name);
+    const execution::Backend backend = execution::parseBackend(backend_name);
+    if (stage == execution::kMaxStage || backend == execution::kMaxBackend) {
+        output::line() << "Формат: backend [<video | audio | classify | decode> <scalar | simd | threaded>]";
+        return;
+    }
+    translator.setBackend(stage, backend);
+}
+
+/*!
+ * @brief Управление трассировкой
+ * @param[in] argument Аргумент команды trace
+ * @param[in,out] exit_path Файл, в который трасса выгружается при выходе
+ */
+void configureTrace(const std::string& argument, std::string& exit_path) {
+    if (!trace::kCompiled) {
+        output::line() << "Трассировка отключена при сборке (ENABLE_TRACING=OFF)";
+        return;
+    }
+    std::istringstream stream(argument);
+    std::string mode, path;
+    stream >> mode >> path;
+    if (mode == "on") {
+        trace::setRecording(true);
+        exit_path = path;
+        output::line() << "Запись трассы включена" << (path.empty() ? "" : ", при выходе трасса будет выгружена в ")
+                       << path;
+    } else if (mode == "off") {
+        trace::setRecording(false);
+        exit_path.clear();
+        output::line() << "Запись трассы выключена";
+    } else if (mode.empty()) {
+        output::line() << "Формат: trace on [<путь>] | off | <путь>";
+    } else if (trace::dump(mode)) {
+        output::line() << "Трасса выгружена в " << mode;
+    } else {
+        output::line() << "Не удалось записать " << mode;
+    }
+}
+
+/*!
+ * @brief Выбор языка сообщений
+ * @param[in,out] translator Устройство
+ * @param[in] argument Аргумент команды lang
+ */
+void configureLocale(translator::AnimalTranslatinator& translator, const std::string& argument) {
+    if (argument.empty()) {
+        const messages::Catalog& catalog = messages::current();
+        output::Line line(output::sink());
+        line << "Языки сообщений:";
+        for (messages::Locale locale = 0; locale < catalog.locales(); locale++)
+            line << ' ' << catalog.localeName(locale);
+        line << ", выбран " << translator.localeName();
+        return;
+    }
+    if (!translator.setLocale(argument))
+        output::line() << "Язык " << argument << " отсутствует в каталоге сообщений";
+}
+
+/*!
+ * @brief Загрузка каталога сообщений
+ * Устройства сохраняют выбранный язык, если он есть в новом каталоге, иначе переходят на первый язык каталога.
+ * @param[in,out] translator Устройство
+ * @param[in] path Путь к файлу каталога
+ */
+void loadCatalog(translator::AnimalTranslatinator& translator, const std::string& path) {
+    std::string error;
+    if (!messages::load(path, error)) {
+        output::line() << "Не удалось загрузить каталог сообщений: " << error;
+        return;
+    }
+    const messages::Catalog& catalog = messages::current();
+    output::line() << "Каталог сообщений " << path << " загружен: языков " << catalog.locales() << ", текстов "
+                   << catalog.bytes() << " байт, язык сообщений " << translator.localeName();
+}
+
+/*!
+ * @brief Классификация, специализированная по видам
+ * @param[in,out] translator Устройство
+ * @param[in] argument Аргумент команды species
+ */
+void configureSpecies(translator::AnimalTranslatinator& translator, const std::string& argument) {
+    std::istringstream stream(argument);
+    std::string mode, count;
+    stream >> mode >> count;
+    if (mode == "on" || mode == "off") {
+        translator.setSpecialization(mode == "on");
+        return;
+    }
+    if (mode == "bench") {
+        size_t animals = kSpeciesBenchmarkAnimals;
+        std::istringstream(count) >> animals;
+        translator.runSpeciesBenchmark(animals);
+        return;
+    }
+    output::line() << "Формат: species on | off | bench [<животных>]";
+}
+
+/*!
+ * @brief Замер примитива или стадии обработки
+ * @param[in] pool Общий пул потоков
+ * @param[in] argument Аргумент команды bench
+ */
+void runBenchmark(concurrency::TaskPool& pool, const std::string& argument) {
+    std::istringstream stream(argument);
+    std::string name;
+    size_t count = 0;
+    stream >> name >> count;
+    if (name == "queue")
+        bench::runCommandQueue(count ? count : kQueueBenchmarkCommands);
+    else if (name == "ring")
+        bench::runFrameRing(count ? count : kRingBenchmarkFrames);
+    else if (name == "pool")
+        bench::runTaskPool(count ? count : kPoolBenchmarkFrames);
+    else if (name == "classify")
+        bench::runClassifier(count ? count : kClassifierBenchmarkAnimals);
+    else if (name == "tables")
+        bench::runTraitTables(count ? count : kTablesBenchmarkAnimals);
+    else if (name == "fft")
+        bench::runSpectrum(pool, count ? count : kSpectrumBenchmarkSeconds);
+    else if (name == "depth")
+        bench::runDepthMap(pool, count ? count : kDepthBenchmarkFrames);
+    else if (name == "alloc")
+        bench::runAllocations(pool, count ? count : kAllocationCheckFrames);
+    else
+        output::line() << "Формат: bench queue [<команд>] | ring [<кадров>] | pool [<кадров>] | classify [<животных>] "
+                          "| tables [<животных>] | fft [<секунд>] | depth [<кадров>] | alloc [<кадров>]";
+}
+
+int main(int argc, char* argv[]) {
+    animal::AudioRing audio(kAudioRingCapacity);
+    concurrency::ReadinessEvent reactive_cv_;
+    // Окружение и каждый источник нагрузки пишут кадры в собственные полосы шины
+    animal::FrameBus frames(reactive_cv_);
+    const size_t environment_lane = frames.addLane(kFrameRingCapacity);
+    for (size_t iter = 0; iter < kMaxLoadProducers; iter++) frames.addLane(kLoadLaneCapacity);
     // Создаем внешние реакции в виде "животных"
-    reactor::AnimalReactor env(pantomime, sound, types, reactive_cv_);
+    reactor::AnimalReactor env(frames.lane(environment_lane), audio, reactive_cv_);
+    reactor::LoadGenerator load(frames, environment_lane + 1);
+    // Общий пул потоков для параллельной обработки данных
+    concurrency::TaskPool pool;
     // Создаем переводчик
-    translator::AnimalTranslatinator translator(pantomime, sound, reactive_cv_);
-    std::cout << "Начинаем проверку работоспособностии устройства" << std::endl;
+    translator::AnimalTranslatinator translator(frames, audio, pool);
+    // Трасса выгружается при выходе, если путь задан командой trace on
+    std::string trace_path;
+    trace::nameThread("устройство");
+    output::line() << "Начинаем проверку работоспособностии устройства";
+    // Каталог сообщений может быть передан первым аргументом, иначе используется встроенный
+    if (argc > 1)
+        loadCatalog(translator, argv[1]);
     // Запускаем производство объектов с животными
     std::thread console_thread(&listenConsole);
-    while (is_working) {
-        if (commandQueue.empty())
-            continue;
-        Command command = commandQueue.front();
-        commandQueue.pop_front();
-        switch (command) {
-            case kTalk:
+    // Окружение живет в собственном потоке, чтобы устройство могло ждать беседу, пока животные говорят
+    std::thread reactor_thread([&env] {
+        trace::nameThread("окружение");
+        for (Command command = reactorQueue.pop(); command.type != kExit; command = reactorQueue.pop()) {
+            if (command.type == kTalk)
                 env.startTalking();
-                break;
+            else if (command.argument.empty())
+                env.stopRecording();
+            else
+                env.startRecording(command.argument);
+        }
+        env.stopRecording();
+    });
+    while (is_working) {
+        // Поток диспетчера спит, пока в очереди нет команд
+        Command command = commandQueue.pop();
+        switch (command.type) {
             case kListen: {
-                double score = translator.startListening(types);
-                std::cout << "Общая длительность обработки " << score << " секунд" << std::endl;
+                const translator::ListenTiming timing = translator.startListening();
+                output::Line line(output::sink());
+                line << "Общая длительность обработки " << timing.measured << " секунд";
+                if (timing.projected > 0)
+                    line << " (проекция на аппаратуру устройства " << timing.projected << " секунд)";
+                line << ", выделений памяти " << timing.allocations;
             } break;
             case kOn:
                 translator.turnOn();
@@ -99,38 +483,141 @@ int main() {
             case kOff:
                 translator.turnOff();
                 break;
+            // Аппаратное исполнение стадий соответствует векторной и многопоточной реализациям
             case kHardVideo:
-                translator.setHardwareVideo(true);
+                translator.setBackend(execution::kVideo, execution::kSimd);
                 break;
             case kSoftVideo:
-                translator.setHardwareVideo(false);
+                translator.setBackend(execution::kVideo, execution::kScalar);
                 break;
             case kHardAudio:
-                translator.setHardwareAudio(true);
+                translator.setBackend(execution::kAudio, execution::kSimd);
                 break;
             case kSoftAudio:
-                translator.setHardwareAudio(false);
+                translator.setBackend(execution::kAudio, execution::kScalar);
                 break;
             case kGpuClassify:
-                translator.setHardwareClassify(0);
+                translator.setBackend(execution::kClassify, execution::kThreaded);
                 break;
             case kNpuClassify:
-                translator.setHardwareClassify(1);
+                translator.setBackend(execution::kClassify, execution::kSimd);
                 break;
             case kCpuClassify:
-                translator.setHardwareClassify(2);
+                translator.setBackend(execution::kClassify, execution::kScalar);
                 break;
             case kHardDecoding:
-                translator.setHardwareDecoding(true);
+                translator.setBackend(execution::kDecode, execution::kThreaded);
                 break;
             case kSoftDecoding:
-                translator.setHardwareDecoding(false);
+                translator.setBackend(execution::kDecode, execution::kScalar);
+                break;
+            case kBackend:
+                configureBackend(translator, command.argument);
+                break;
+            case kParallelFormatting:
+                translator.setParallelFormatting(true);
+                break;
+            case kSerialFormatting:
+                translator.setParallelFormatting(false);
+                break;
+            case kStreamStart:
+                translator.startStreaming();
+                break;
+            case kStreamStop:
+                translator.stopStreaming();
+                break;
+            case kStreamStats:
+                translator.printStreamingStats();
+                break;
+            case kReplay:
+                translator.replay(command.argument);
+                break;
+            case kLoad: {
+                reactor::LoadProfile profile;
+                if (command.argument.empty())
+                    load.stop();
+                else if (parseLoadProfile(command.argument, profile))
+                    load.start(profile);
+                else
+                    output::line()
+                        << "Формат: load <источники> <кадров/с> <секунды> [<мин.> <макс. животных>] [<зерно>] "
+                           "[<неподвижных от 0 до 1>]";
+            } break;
+            case kHost: {
+                size_t devices = 0;
+                if (command.argument.empty()) {
+                    for (devices = 1; devices <= kMaxHostedDevices; devices *= 2)
+                        host::runBenchmark(pool, devices, kHostBenchmarkSeconds);
+                } else if (std::istringstream(command.argument) >> devices && devices > 0 &&
+                           devices <= kMaxHostedDevices)
+                    host::runBenchmark(pool, devices, kHostBenchmarkSeconds);
+                else
+                    output::line() << "Формат: host [<устройств от 1 до " << kMaxHostedDevices << ">]";
+            } break;
+            case kLatency:
+                if (command.argument.empty())
+                    latency::print();
+                else if (command.argument == "reset")
+                    latency::reset();
+                else if (latency::exportCsv(command.argument))
+                    output::line() << "Задержки стадий выгружены в " << command.argument;
+                else
+                    output::line() << "Не удалось записать " << command.argument;
+                break;
+            case kProjection:
+                translator.setProjection(command.argument != "off");
+                break;
+            case kOutput:
+                configureOutput(command.argument);
+                break;
+            case kTrace:
+                configureTrace(command.argument, trace_path);
+                break;
+            case kLocale:
+                configureLocale(translator, command.argument);
+                break;
+            case kCatalog:
+                loadCatalog(translator, command.argument);
+                break;
+            case kPredictionCache:
+                if (command.argument == "on" || command.argument == "off")
+                    translator.setMemoization(command.argument == "on");
+                else if (command.argument.empty() || command.argument == "reset")
+                    translator.printPredictionStats(command.argument == "reset");
+                else
+                    output::line() << "Формат: cache [reset | on | off]";
+                break;
+            case kTracking:
+                if (command.argument == "on" || command.argument == "off")
+                    translator.setIncremental(command.argument == "on");
+                else if (command.argument.empty())
+                    translator.printTrackingStats();
+                else if (command.argument.starts_with("check ") && command.argument.size() > 6)
+                    translator.checkTracking(command.argument.substr(6));
+                else
+                    output::line() << "Формат: track [on | off | check <путь>]";
+                break;
+            case kSpecies:
+                configureSpecies(translator, command.argument);
+                break;
+            case kBenchmark:
+                runBenchmark(pool, command.argument);
+                break;
+            case kTalk:
+            case kRecord:
                 break;
             case kExit:
+                // Закрытие потока микрофона будит окружение и датчики, ожидающие звук
+                audio.close();
+                load.stop();
+                reactorQueue.push({kExit});
                 is_working = false;
                 break;
         }
     }
+    reactor_thread.join();
+    if (!trace_path.empty() && trace::dump(trace_path))
+        output::line() << "Трасса выгружена в " << trace_path;
     console_thread.join();
     return 0;
 }